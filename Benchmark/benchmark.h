@@ -0,0 +1,35 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+/**
+ * Helpers of the host benchmarks. Each result is printed on one line as name,
+ * value and unit. Times are wall clock of the host, only runs on the same
+ * machine can be compared.
+ */
+
+/*******************| Inclusions |*************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_REPORT(name, value, unit) \
+  printf("%-52s %14.3f %s\n", (name), (double)(value), (unit))
+
+/*******************| Global variables |*******************************/
+/* results are summed up here, thus the compiler can not drop the work */
+static volatile unsigned long Benchmark_sink;
+
+/*******************| Function definition |****************************/
+/**
+ * @return monotonic time in ns
+ */
+static inline double Benchmark_now(void)
+{
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+#endif
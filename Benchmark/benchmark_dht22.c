@@ -0,0 +1,168 @@
+/*******************| Inclusions |*************************************/
+#include "benchmark.h"
+#include "dht22_hal_host.h"
+
+/**
+ * @brief Host benchmark of the DHT22 module
+ * - RAM per sensor instance
+ * - round robin scheduler: read-outs per sensor and share of time the bus is
+ *   busy for a growing number of sensors, at most one read-out may run
+ * - decoding recorded frames: the former bit by bit decoder of
+ *   DHT22_readValues against DHT22_decodeFrames
+*/
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_NUMBEROFFRAMES        1024
+#define BENCHMARK_NUMBEROFROUNDS        2048
+
+/*******************| Global variables |*******************************/
+static uint32_t toggles[DHT22_HOSTMAXTOGGLES];
+static uint8_t width[BENCHMARK_NUMBEROFFRAMES * DHT22_NUMBEROFBITSFROMSENSOR];
+static DHT22_SensorValue_t values[BENCHMARK_NUMBEROFFRAMES];
+
+/*******************| Function definition |****************************/
+static void benchmarkMemory(void)
+{
+  BENCHMARK_REPORT("DHT22_Handle_t RAM per sensor (host layout)", sizeof(DHT22_Handle_t), "byte");
+  BENCHMARK_REPORT("DHT22_Scheduler_t RAM (host layout)", sizeof(DHT22_Scheduler_t), "byte");
+}
+
+static void benchmarkScheduler(uint8_t numberOfSensors)
+{
+  DHT22_Handle_t sensors[DHT22_HOSTNUMBEROFLINES] = { { 0 } };
+  DHT22_Scheduler_t scheduler;
+  char name[64];
+  uint32_t busyMs = 0;
+  uint32_t readouts = 0;
+  uint8_t maxRunning = 0;
+  uint8_t running;
+  uint32_t ms;
+  uint8_t sensor;
+
+  DHT22_hostInit();
+  for (sensor = 0; sensor < numberOfSensors; sensor++)
+  {
+    DHT22_hostSetResponse(sensor, toggles, DHT22_hostEncodeFrame(500, 200, toggles));
+    DHT22_initSensor(&sensors[sensor], &DHT22_hostPin[sensor]);
+  }
+  DHT22_initScheduler(&scheduler, sensors, numberOfSensors, 0);
+  /* one minute in steps of 1ms */
+  for (ms = 0; ms < 60000; ms++)
+  {
+    DHT22_hostRunUntil(ms * 1000);
+    DHT22_runScheduler(&scheduler, DHT22_hostReadTimer(), (uint16_t)ms);
+    running = 0;
+    for (sensor = 0; sensor < numberOfSensors; sensor++)
+    {
+      if (sensors[sensor].state == DHT22State_ReadInProgress) running++;
+    }
+    if (running) busyMs++;
+    if (running > maxRunning) maxRunning = running;
+  }
+  for (sensor = 0; sensor < numberOfSensors; sensor++)
+  {
+    readouts += sensors[sensor].statistics.readCounter;
+  }
+  sprintf(name, "scheduler %u sensor(s): read-outs per sensor and minute", numberOfSensors);
+  BENCHMARK_REPORT(name, (double)readouts / numberOfSensors, "");
+  sprintf(name, "scheduler %u sensor(s): bus busy", numberOfSensors);
+  BENCHMARK_REPORT(name, busyMs / 600.0, "%");
+  sprintf(name, "scheduler %u sensor(s): read-outs running at once", numberOfSensors);
+  BENCHMARK_REPORT(name, maxRunning, "");
+}
+
+/**
+ * Decoder of DHT22_readValues before the pulse widths were recorded: one shift,
+ * divide and branch per bit, followed by the CRC check and sign correction.
+ */
+static uint16_t baselineDecodeFrames(const uint8_t *width, uint8_t threshold, DHT22_SensorValue_t *values, uint16_t numberOfFrames)
+{
+  uint16_t validFrames = 0;
+  uint8_t bitCounter;
+  uint16_t temperatur;
+
+  while (numberOfFrames--)
+  {
+    bitCounter = DHT22_NUMBEROFBITSFROMSENSOR;
+    while (bitCounter--)
+    {
+      values->raw[bitCounter / 8] = values->raw[bitCounter / 8] << 1;
+      if (*width++ < threshold)
+      {
+        values->raw[bitCounter / 8] &= 0xfe;
+      } else {
+        values->raw[bitCounter / 8] |= 0x01;
+      }
+    }
+    if (values->raw[0] == (uint8_t)(values->raw[1] + values->raw[2] + values->raw[3] + values->raw[4]))
+    {
+      temperatur = ((uint16_t)(values->raw[2] & 0x7f) << 8) | values->raw[1];
+      values->values.RelativeHumidity = ((uint16_t)values->raw[4] << 8) | values->raw[3];
+      values->values.Temperatur = (values->raw[2] & 0x80) ? -(sint16_t)temperatur : (sint16_t)temperatur;
+      validFrames++;
+    }
+    values++;
+  }
+  return validFrames;
+}
+
+/**
+ * Frames with random values and pulse widths jittering around both lengths
+ */
+static void generateFrames(void)
+{
+  uint32_t seed = 1;
+  uint8_t frame[DHT22_NUMBEROFBITSFROMSENSOR / 8];
+  uint8_t *bitWidth = width;
+  uint16_t count;
+  uint8_t bit;
+
+  for (count = 0; count < BENCHMARK_NUMBEROFFRAMES; count++)
+  {
+    for (bit = 0; bit < 4; bit++)
+    {
+      seed = seed * 1103515245UL + 12345UL;
+      frame[bit] = (uint8_t)(seed >> 16);
+    }
+    frame[4] = (uint8_t)(frame[0] + frame[1] + frame[2] + frame[3]);
+    for (bit = 0; bit < DHT22_NUMBEROFBITSFROMSENSOR; bit++)
+    {
+      seed = seed * 1103515245UL + 12345UL;
+      *bitWidth++ = (uint8_t)(((frame[bit / 8] & (0x80 >> (bit % 8))) ? 50 : 20) + ((seed >> 16) & 0x07));
+    }
+  }
+}
+
+static void benchmarkDecoder(void)
+{
+  double frames = (double)BENCHMARK_NUMBEROFFRAMES * BENCHMARK_NUMBEROFROUNDS;
+  double start;
+  uint16_t round;
+
+  generateFrames();
+  start = Benchmark_now();
+  for (round = 0; round < BENCHMARK_NUMBEROFROUNDS; round++)
+  {
+    Benchmark_sink += baselineDecodeFrames(width, 38, values, BENCHMARK_NUMBEROFFRAMES);
+  }
+  BENCHMARK_REPORT("decoder bit by bit: time per frame", (Benchmark_now() - start) / frames, "ns");
+  start = Benchmark_now();
+  for (round = 0; round < BENCHMARK_NUMBEROFROUNDS; round++)
+  {
+    Benchmark_sink += DHT22_decodeFrames(width, 38, values, BENCHMARK_NUMBEROFFRAMES);
+  }
+  BENCHMARK_REPORT("DHT22_decodeFrames: time per frame", (Benchmark_now() - start) / frames, "ns");
+}
+
+int main(void)
+{
+  uint8_t numberOfSensors;
+
+  benchmarkMemory();
+  for (numberOfSensors = 1; numberOfSensors <= DHT22_HOSTNUMBEROFLINES; numberOfSensors++)
+  {
+    benchmarkScheduler(numberOfSensors);
+  }
+  benchmarkDecoder();
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*******************| Inclusions |*************************************/
+#include "benchmark.h"
+#include "gp2y1050_hal.h"
+
+/**
+ * @brief Host benchmark of the GP2Y1050 module
+ * - throughput of the filter stage (sort, trim, average) and the conversion
+ *   to dust density for growing burst lengths
+ * - complete bursts on the simulated ADC of the host backend
+*/
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_NUMBEROFBURSTS        (1UL << 20)
+#define BENCHMARK_MAXSAMPLES            64
+
+/* simulated time is 32 bit us, i.e. wraps after 4096 bursts of 16 samples */
+#define BENCHMARK_NUMBEROFSIMULATEDBURSTS       2048
+
+/*******************| Global variables |*******************************/
+static uint16_t noisySamples[BENCHMARK_MAXSAMPLES];
+
+/*******************| Function definition |****************************/
+/**
+ * 11 bit samples around 1V with noise, the filter sorts a copy of them
+ */
+static void generateSamples(void)
+{
+  uint32_t seed = 1;
+  uint8_t sample;
+
+  for (sample = 0; sample < BENCHMARK_MAXSAMPLES; sample++)
+  {
+    seed = seed * 1103515245UL + 12345UL;
+    noisySamples[sample] = (uint16_t)(620 + ((seed >> 16) & 0x3f));
+  }
+}
+
+static void benchmarkFilter(uint8_t numberOfSamples)
+{
+  uint16_t samples[BENCHMARK_MAXSAMPLES];
+  char name[64];
+  uint32_t burst;
+  uint8_t sample;
+  double start;
+  double time;
+
+  start = Benchmark_now();
+  for (burst = 0; burst < BENCHMARK_NUMBEROFBURSTS; burst++)
+  {
+    for (sample = 0; sample < numberOfSamples; sample++)
+    {
+      samples[sample] = noisySamples[(sample + burst) % BENCHMARK_MAXSAMPLES];
+    }
+    Benchmark_sink += GP2Y1050_calculateDustDensity(GP2Y1050_filterSamples(samples, numberOfSamples));
+  }
+  time = (Benchmark_now() - start) / BENCHMARK_NUMBEROFBURSTS;
+  sprintf(name, "filter %u samples: time per burst", numberOfSamples);
+  BENCHMARK_REPORT(name, time, "ns");
+  sprintf(name, "filter %u samples: throughput", numberOfSamples);
+  BENCHMARK_REPORT(name, numberOfSamples * 1e3 / time, "Msamples/s");
+}
+
+static void benchmarkSimulatedBursts(void)
+{
+  uint32_t bursts = 0;
+  uint32_t done = 0;
+  double start;
+
+  GP2Y1050_hostInit();
+  GP2Y1050_hostSetVoltage(GP2Y1050_NODUSTVOLTAGEMV + 150, 20);
+  GP2Y1050_init();
+  start = Benchmark_now();
+  while (bursts < BENCHMARK_NUMBEROFSIMULATEDBURSTS)
+  {
+    if (GP2Y1050_startBurst(GP2Y1050_MAXSAMPLES) == GP2Y1050State_Sampling) bursts++;
+    GP2Y1050_hostRunUntil(GP2Y1050_hostTime + GP2Y1050_MAXSAMPLES * GP2Y1050_HOSTPULSEPERIOD);
+    if (GP2Y1050_poll() == GP2Y1050State_ReadDone) done++;
+  }
+  BENCHMARK_REPORT("simulated burst incl. ADC callbacks", (Benchmark_now() - start) / bursts, "ns");
+  BENCHMARK_REPORT("simulated bursts with a result", 100.0 * done / bursts, "%");
+}
+
+int main(void)
+{
+  uint8_t numberOfSamples;
+
+  generateSamples();
+  for (numberOfSamples = 4; numberOfSamples <= BENCHMARK_MAXSAMPLES; numberOfSamples *= 2)
+  {
+    benchmarkFilter(numberOfSamples);
+  }
+  benchmarkSimulatedBursts();
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*******************| Inclusions |*************************************/
+#include "benchmark.h"
+#include "ppd42ns_hal.h"
+
+/**
+ * @brief Host benchmark of the PPD42NS module
+ * - fixed-point ratio and concentration of one channel against the former
+ *   float division with the datasheet polynomial in float. The host FPU makes
+ *   the float path cheap here, the 8051 emulates it in software.
+ * - ISR run time per capture and per overflow event on the simulated Timer1
+*/
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_NUMBEROFCONVERSIONS   (1UL << 24)
+#define BENCHMARK_NUMBEROFPERIODS       20000U
+
+/*******************| Function definition |****************************/
+/**
+ * Float path as done in the ISR before: ratio by float division and
+ * concentration by the datasheet polynomial
+ */
+static float floatConcentration(uint32_t lowPulseOccupancy, uint32_t totalTime)
+{
+  float percent = (float)lowPulseOccupancy / totalTime * 100.0f;
+
+  return (((1.1f * percent - 3.8f) * percent + 520.0f) * percent + 0.62f) * 3531.47f;
+}
+
+static void benchmarkConversion(void)
+{
+  const uint32_t windowTime = PPD42NS_DEFAULTNUMBEROFBUCKETS * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL;
+  uint32_t lowPulseOccupancy = 0;
+  uint32_t conversion;
+  double start;
+
+  start = Benchmark_now();
+  for (conversion = 0; conversion < BENCHMARK_NUMBEROFCONVERSIONS; conversion++)
+  {
+    lowPulseOccupancy = (lowPulseOccupancy + 4093) % (windowTime / 5);
+    Benchmark_sink += PPD42NS_calculateConcentration(PPD42NS_calculateRatio(lowPulseOccupancy, windowTime));
+  }
+  BENCHMARK_REPORT("fixed-point ratio and concentration", (Benchmark_now() - start) / BENCHMARK_NUMBEROFCONVERSIONS, "ns");
+  start = Benchmark_now();
+  for (conversion = 0; conversion < BENCHMARK_NUMBEROFCONVERSIONS; conversion++)
+  {
+    lowPulseOccupancy = (lowPulseOccupancy + 4093) % (windowTime / 5);
+    Benchmark_sink += (unsigned long)floatConcentration(lowPulseOccupancy, windowTime);
+  }
+  BENCHMARK_REPORT("float ratio and polynomial", (Benchmark_now() - start) / BENCHMARK_NUMBEROFCONVERSIONS, "ns");
+}
+
+static void benchmarkIsr(void)
+{
+  double captureTime = 0;
+  double overflowTime = 0;
+  double start;
+  uint16_t period;
+  uint8_t channel;
+
+  PPD42NS_init(NULL);
+  for (period = 0; period < BENCHMARK_NUMBEROFPERIODS; period++)
+  {
+    start = Benchmark_now();
+    for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+    {
+      PPD42NS_hostEdge(channel, 0, (uint16_t)(1000 + channel * 10000));
+      PPD42NS_hostEdge(channel, 1, (uint16_t)(1500 + channel * 10000 + (period & 0xff)));
+    }
+    captureTime += Benchmark_now() - start;
+    start = Benchmark_now();
+    PPD42NS_hostOverflow();
+    overflowTime += Benchmark_now() - start;
+  }
+  BENCHMARK_REPORT("ISR per capture event", captureTime / (2.0 * PPD42NS_NUMBEROFCHANNELS * BENCHMARK_NUMBEROFPERIODS), "ns");
+  BENCHMARK_REPORT("ISR per overflow event, average incl. bucket ends", overflowTime / BENCHMARK_NUMBEROFPERIODS, "ns");
+}
+
+int main(void)
+{
+  benchmarkConversion();
+  benchmarkIsr();
+  return 0;
+}
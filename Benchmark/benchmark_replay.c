@@ -0,0 +1,185 @@
+/*******************| Inclusions |*************************************/
+#include "benchmark.h"
+#include "dht22_hal_host.h"
+#include "ppd42ns_hal.h"
+
+/**
+ * @brief Host benchmark of recorded traces replayed through the drivers
+ * For growing skew, jitter and interrupt latency:
+ * - DHT22: share of read-outs decoding the recorded frame, CPU time of a
+ *   read-out in the driver (start, polls and edge interrupts) and per edge
+ *   interrupt
+ * - PPD42NS: share of windows with a ratio within 1% of the recorded one
+ *   (scaled by the skew),
+ *   CPU time of reading the ratio and per ISR run incl. the replay
+ * GP2Y1050 has no edges to replay, benchmark_gp2y1050 covers its bursts.
+ * Times are host wall clock in ns, not 8051 cycles. They compare distortion
+ * levels and revisions on one machine, the share of decoded frames is what
+ * carries over to the target.
+*/
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_NUMBEROFREADS         2000U
+#define BENCHMARK_NUMBEROFWINDOWS       2000U
+
+/* PPD42NS: 1000us low every 16384us, 16 pulses per window of 4 periods */
+#define BENCHMARK_NUMBEROFBUCKETS       4
+#define BENCHMARK_WINDOWTIME            (BENCHMARK_NUMBEROFBUCKETS * 0x10000UL)
+#define BENCHMARK_NUMBEROFPULSES        16
+#define BENCHMARK_PULSEPERIOD           16384
+#define BENCHMARK_LOWTIME               1000
+
+/*******************| Type definitions |*******************************/
+typedef struct {
+  const char *name;
+  Trace_Distortion_t distortion;
+} Benchmark_Level_t;
+
+/*******************| Global variables |*******************************/
+/**
+ * Falling edges of one frame recorded from a sensor in us after the release
+ * of the data line: 58.4%RH, 22.7Celsius, see test_dht22.c
+ */
+static const uint16_t recordedEdges[DHT22_NUMBEROFEDGESFROMSENSOR] = {
+  31, 193, 269, 344, 421, 500, 574, 648, 771, 849, 923, 1042, 1120, 1194,
+  1315, 1390, 1464, 1538, 1615, 1692, 1766, 1841, 1915, 1993, 2070, 2144, 2267,
+  2388, 2505, 2580, 2659, 2738, 2859, 2976, 3054, 3132, 3252, 3326, 3444,
+  3561, 3639, 3762
+};
+
+static const Benchmark_Level_t levels[] = {
+  { "exact", { 0, 0, 0 } },
+  { "latency 50us", { 0, 0, 50 } },
+  { "skew +2%", { 20000, 0, 0 } },
+  { "jitter 10us", { 0, 10, 0 } },
+  { "jitter 20us", { 0, 20, 0 } },
+  { "jitter 30us", { 0, 30, 0 } },
+  { "jitter 40us", { 0, 40, 0 } },
+  { "skew -2%, jitter 20us, latency 50us", { -20000, 20, 50 } },
+};
+
+static Trace_Event_t dht22Trace[DHT22_NUMBEROFEDGESFROMSENSOR];
+static Trace_Event_t ppd42nsTrace[2 * BENCHMARK_NUMBEROFPULSES];
+
+/*******************| Function definition |****************************/
+static void benchmarkDht22(const Benchmark_Level_t *level)
+{
+  DHT22_Handle_t handle = { 0 };
+  DHT22State_t state;
+  char name[96];
+  double readTime = 0;
+  double edgeTime = 0;
+  double start;
+  uint32_t decoded = 0;
+  uint16_t read;
+  uint8_t edge;
+
+  DHT22_hostInit();
+  DHT22_initSensor(&handle, &DHT22_hostPin[0]);
+  for (read = 0; read < BENCHMARK_NUMBEROFREADS; read++)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + DHT22_MINREADINTERVAL * 1000UL);
+    start = Benchmark_now();
+    DHT22_startSensorRead(&handle, DHT22_hostReadTimer());
+    readTime += Benchmark_now() - start;
+    DHT22_hostRunUntil(DHT22_hostTime + DHT22_MCUSendStartSignalTime);
+    start = Benchmark_now();
+    DHT22_pollSensor(&handle, DHT22_hostReadTimer());
+    readTime += Benchmark_now() - start;
+    DHT22_hostReplay(&handle, dht22Trace, DHT22_NUMBEROFEDGESFROMSENSOR, 0, &level->distortion);
+    do
+    {
+      DHT22_hostRunUntil(DHT22_hostTime + 100);
+      start = Benchmark_now();
+      state = DHT22_pollSensor(&handle, DHT22_hostReadTimer());
+      readTime += Benchmark_now() - start;
+    } while (state == DHT22State_ReadInProgress);
+    if ((state == DHT22State_ReadDone) && (handle.value.values.RelativeHumidity == 584) && (handle.value.values.Temperatur == 227)) decoded++;
+  }
+  /* the replay includes the host simulation, thus the edge interrupts are
+   * timed on their own with the undistorted frame */
+  for (read = 0; read < BENCHMARK_NUMBEROFREADS; read++)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + DHT22_MINREADINTERVAL * 1000UL);
+    DHT22_startSensorRead(&handle, DHT22_hostReadTimer());
+    DHT22_hostRunUntil(DHT22_hostTime + DHT22_MCUSendStartSignalTime);
+    DHT22_pollSensor(&handle, DHT22_hostReadTimer());
+    start = Benchmark_now();
+    for (edge = 0; edge < DHT22_NUMBEROFEDGESFROMSENSOR; edge++)
+    {
+      DHT22_sensorEdgeCallback(&handle, (uint16_t)(DHT22_hostReadTimer() + recordedEdges[edge]));
+    }
+    edgeTime += Benchmark_now() - start;
+    DHT22_hostRunUntil(DHT22_hostTime + 5000);
+    DHT22_pollSensor(&handle, DHT22_hostReadTimer());
+  }
+  sprintf(name, "DHT22 %s: decoded", level->name);
+  BENCHMARK_REPORT(name, 100.0 * decoded / BENCHMARK_NUMBEROFREADS, "%");
+  sprintf(name, "DHT22 %s: CPU per read-out", level->name);
+  BENCHMARK_REPORT(name, (readTime + edgeTime) / BENCHMARK_NUMBEROFREADS, "ns");
+  sprintf(name, "DHT22 %s: edge interrupt", level->name);
+  BENCHMARK_REPORT(name, edgeTime / ((double)BENCHMARK_NUMBEROFREADS * DHT22_NUMBEROFEDGESFROMSENSOR), "ns");
+}
+
+static void benchmarkPpd42ns(const Benchmark_Level_t *level)
+{
+  const PPD42NS_Config_t config = { 1, BENCHMARK_NUMBEROFBUCKETS, NULL };
+  /* overflows of the replay are not skewed, thus skew stretches the pulses
+   * against the window */
+  const uint16_t expected = (uint16_t)(0x10000LL * BENCHMARK_LOWTIME * (1000000 + level->distortion.skewPpm) / (1000000LL * BENCHMARK_PULSEPERIOD));
+  char name[96];
+  double readTime = 0;
+  double isrTime = 0;
+  double start;
+  uint32_t accurate = 0;
+  uint16_t window;
+  uint16_t ratio;
+
+  PPD42NS_hostTime = 0;
+  PPD42NS_init(&config);
+  for (window = 0; window < BENCHMARK_NUMBEROFWINDOWS; window++)
+  {
+    start = Benchmark_now();
+    PPD42NS_hostReplay(ppd42nsTrace, 2 * BENCHMARK_NUMBEROFPULSES, &level->distortion);
+    PPD42NS_hostRunUntil((PPD42NS_hostTime | (BENCHMARK_WINDOWTIME - 1)) + 1);
+    isrTime += Benchmark_now() - start;
+    start = Benchmark_now();
+    PPD42NS_readRatio(0, PPD42NS_CHANNEL_P1, &ratio);
+    readTime += Benchmark_now() - start;
+    if ((ratio >= expected - expected / 100) && (ratio <= expected + expected / 100)) accurate++;
+  }
+  sprintf(name, "PPD42NS %s: ratio within 1%%", level->name);
+  BENCHMARK_REPORT(name, 100.0 * accurate / BENCHMARK_NUMBEROFWINDOWS, "%");
+  sprintf(name, "PPD42NS %s: CPU per ratio read-out", level->name);
+  BENCHMARK_REPORT(name, readTime / BENCHMARK_NUMBEROFWINDOWS, "ns");
+  sprintf(name, "PPD42NS %s: ISR run incl. simulation", level->name);
+  BENCHMARK_REPORT(name, isrTime / (BENCHMARK_NUMBEROFWINDOWS * (2.0 * BENCHMARK_NUMBEROFPULSES + BENCHMARK_NUMBEROFBUCKETS)), "ns");
+}
+
+int main(void)
+{
+  uint8_t level;
+  uint8_t edge;
+
+  for (edge = 0; edge < DHT22_NUMBEROFEDGESFROMSENSOR; edge++)
+  {
+    dht22Trace[edge].timestamp = recordedEdges[edge];
+    dht22Trace[edge].channel = 0;
+    dht22Trace[edge].level = 0;
+  }
+  for (edge = 0; edge < 2 * BENCHMARK_NUMBEROFPULSES; edge++)
+  {
+    ppd42nsTrace[edge].timestamp = (uint32_t)(edge / 2) * BENCHMARK_PULSEPERIOD + 1000 + ((edge & 1) ? BENCHMARK_LOWTIME : 0);
+    ppd42nsTrace[edge].channel = 0;
+    ppd42nsTrace[edge].level = (uint8_t)(edge & 1);
+  }
+  for (level = 0; level < sizeof(levels) / sizeof(levels[0]); level++)
+  {
+    benchmarkDht22(&levels[level]);
+  }
+  for (level = 0; level < sizeof(levels) / sizeof(levels[0]); level++)
+  {
+    benchmarkPpd42ns(&levels[level]);
+  }
+  return 0;
+}
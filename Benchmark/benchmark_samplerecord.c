@@ -0,0 +1,162 @@
+/*******************| Inclusions |*************************************/
+#include "benchmark.h"
+#include "samplerecord.h"
+
+/**
+ * @brief Host benchmark of the SampleRecord module
+ * A day of samples of one node: DHT22 temperature and humidity every 2s,
+ * PPD42NS P1/P2 concentration and GP2Y1050 dust density every 30s with noise,
+ * occasional error status. Reported are the encoded bytes per record against
+ * the unpacked record (timestamp, value, sensor id and status: 10 bytes), the
+ * records per 102 byte radio payload and encode/decode time.
+*/
+
+/*******************| Macros |*****************************************/
+#define BENCHMARK_DURATION              86400UL
+#define BENCHMARK_MAXRECORDS            (BENCHMARK_DURATION / 2 * 2 + BENCHMARK_DURATION / 30 * 3)
+#define BENCHMARK_UNPACKEDLENGTH        10
+/* IEEE 802.15.4 payload left by the network stack of the CC2530 */
+#define BENCHMARK_PAYLOADLENGTH         102
+#define BENCHMARK_STORESIZE             255
+
+/* sensor ids */
+#define BENCHMARK_TEMPERATURE           0
+#define BENCHMARK_HUMIDITY              1
+#define BENCHMARK_PPD42NSP1             2
+#define BENCHMARK_PPD42NSP2             3
+#define BENCHMARK_GP2Y1050              4
+
+/*******************| Global variables |*******************************/
+static SampleRecord_t samples[BENCHMARK_MAXRECORDS];
+static uint32_t numberOfSamples;
+static uint32_t randomState = 1;
+
+/*******************| Function definition |****************************/
+/**
+ * @return uniformly distributed in -range..range
+ */
+static sint32_t noise(sint32_t range)
+{
+  randomState = randomState * 1664525UL + 1013904223UL;
+  return (sint32_t)((randomState >> 8) % (2UL * range + 1)) - range;
+}
+
+static void addSample(uint32_t timestamp, uint8_t sensorId, sint32_t value, uint8_t status)
+{
+  samples[numberOfSamples].timestamp = timestamp;
+  samples[numberOfSamples].sensorId = sensorId;
+  samples[numberOfSamples].value = value;
+  samples[numberOfSamples].status = status;
+  numberOfSamples++;
+}
+
+/**
+ * Slow daily cycles with sensor noise, values in the unit of the drivers
+ */
+static void generateSamples(void)
+{
+  sint32_t temperature = 200;
+  sint32_t humidity = 550;
+  uint32_t time;
+
+  for (time = 0; time < BENCHMARK_DURATION; time += 2)
+  {
+    /* 0.1Celsius and 0.1%RH steps every few minutes */
+    if (noise(60) == 0) temperature += (time < BENCHMARK_DURATION / 2) ? 1 : -1;
+    if (noise(40) == 0) humidity += (time < BENCHMARK_DURATION / 2) ? -1 : 1;
+    /* one failed read-out in 500 keeps the previous value */
+    addSample(time, BENCHMARK_TEMPERATURE, temperature + noise(1), (uint8_t)((noise(250) == 0) ? 4 : 0));
+    addSample(time, BENCHMARK_HUMIDITY, humidity + noise(2), 0);
+    if ((time % 30) == 0)
+    {
+      /* particles/m^3 and ug/m^3 */
+      addSample(time, BENCHMARK_PPD42NSP1, 1500000 + noise(200000), 0);
+      addSample(time, BENCHMARK_PPD42NSP2, 200000 + noise(50000), 0);
+      addSample(time, BENCHMARK_GP2Y1050, 35 + noise(5), 0);
+    }
+  }
+}
+
+/**
+ * Fill the store, send it in radio payloads until empty, repeat
+ */
+static void benchmarkBatches(void)
+{
+  SampleRecord_t records[BENCHMARK_STORESIZE];
+  SampleRecord_Store_t store;
+  uint8_t payload[BENCHMARK_PAYLOADLENGTH];
+  uint32_t sample = 0;
+  uint32_t payloads = 0;
+  uint32_t bytes = 0;
+  uint16_t length;
+  uint8_t numberOfRecords;
+
+  SampleRecord_initStore(&store, records, BENCHMARK_STORESIZE);
+  while (sample < numberOfSamples)
+  {
+    while ((store.count < BENCHMARK_STORESIZE) && (sample < numberOfSamples))
+    {
+      SampleRecord_append(&store, &samples[sample++]);
+    }
+    while (store.count)
+    {
+      length = SampleRecord_encodeBatch(&store, payload, BENCHMARK_PAYLOADLENGTH, &numberOfRecords);
+      SampleRecord_consume(&store, numberOfRecords);
+      bytes += length;
+      payloads++;
+    }
+  }
+  BENCHMARK_REPORT("records per radio payload", (double)numberOfSamples / payloads, "records");
+  BENCHMARK_REPORT("radio payloads, packed", payloads, "frames/day");
+  BENCHMARK_REPORT("radio payloads, unpacked", (numberOfSamples + BENCHMARK_PAYLOADLENGTH / BENCHMARK_UNPACKEDLENGTH - 1) / (BENCHMARK_PAYLOADLENGTH / BENCHMARK_UNPACKEDLENGTH), "frames/day");
+  BENCHMARK_REPORT("packed bytes per record, batches", (double)bytes / numberOfSamples, "bytes");
+}
+
+/**
+ * One stream of all samples: bytes per record and coder throughput
+ */
+static void benchmarkStream(void)
+{
+  static uint8_t stream[BENCHMARK_MAXRECORDS * SAMPLERECORD_MAXENCODEDLENGTH];
+  SampleRecord_Coder_t coder;
+  SampleRecord_t record;
+  uint32_t length = 0;
+  uint32_t position = 0;
+  uint32_t sample;
+  uint32_t errors = 0;
+  double start;
+
+  SampleRecord_initCoder(&coder);
+  start = Benchmark_now();
+  for (sample = 0; sample < numberOfSamples; sample++)
+  {
+    length += SampleRecord_encode(&coder, &samples[sample], &stream[length], SAMPLERECORD_MAXENCODEDLENGTH);
+  }
+  BENCHMARK_REPORT("encode per record", (Benchmark_now() - start) / numberOfSamples, "ns");
+  SampleRecord_initCoder(&coder);
+  start = Benchmark_now();
+  for (sample = 0; sample < numberOfSamples; sample++)
+  {
+    position += SampleRecord_decode(&coder, &stream[position], SAMPLERECORD_MAXENCODEDLENGTH, &record);
+    Benchmark_sink += (unsigned long)record.value;
+  }
+  BENCHMARK_REPORT("decode per record", (Benchmark_now() - start) / numberOfSamples, "ns");
+  SampleRecord_initCoder(&coder);
+  for (sample = 0, position = 0; sample < numberOfSamples; sample++)
+  {
+    position += SampleRecord_decode(&coder, &stream[position], SAMPLERECORD_MAXENCODEDLENGTH, &record);
+    if ((record.value != samples[sample].value) || (record.timestamp != samples[sample].timestamp)) errors++;
+  }
+  BENCHMARK_REPORT("records per day", numberOfSamples, "records");
+  BENCHMARK_REPORT("packed bytes per record, one stream", (double)length / numberOfSamples, "bytes");
+  BENCHMARK_REPORT("compression ratio, unpacked / packed", (double)BENCHMARK_UNPACKEDLENGTH * numberOfSamples / length, ":1");
+  BENCHMARK_REPORT("decoding mismatches", errors, "records");
+}
+
+int main(void)
+{
+  generateSamples();
+  benchmarkStream();
+  benchmarkBatches();
+  return 0;
+}
@@ -1,119 +1,624 @@
-/*******************| Inclusions |*************************************/
-#include "dht22.h"
-#include <dht22_cfg.h>
-
-/*******************| Macros |*****************************************/
-
-/*******************| Type definitions |*******************************/
-
-/*******************| Global variables |*******************************/
-static DHT22State_t DHT22State = DHT22State_Uninit;
-DHT22_SensorValue_t DHT22_SensorValue;
-#ifdef DHT22_DEBUG
-/**
- * Copy of the wait counters for the communication between the sensor and
- * the MCU. These values can be used to match your MCU to the sensor and helps
- * to configure the values in dht22_cfg.h
-*/
-volatile uint16_t DHT22_sensorWaitCounter[2];
-/**
- * Copy of the bit wait counters for the communication between the sensor and
- * the MCU. These values can be used to match your MCU to the sensor  and helps
- * to configure the values in dht22_cfg.h
-*/
-volatile uint16_t DHT22_sensorBitWaitCounter[DHT22_NUMBEROFBITSFROMSENSOR];
-#endif
-
-/*******************| Function definition |****************************/
-void DHT22_init(void)
-{
-  DHT22_SetDataLineOutput();
-  DHT22_WriteDataBitHigh();
-  DHT22State = DHT22State_Init;
-}
-
-/* 
- * Do read-out from the sensor. Read-out will only be started if no other 
- * read-out is done right now.
- * @return if read could be started funciton will return DHT22_OK, if not
- * DHT22_NOT_OK
- */
-DHT22State_t DHT22_readValues(void)
-{
-  uint8_t waitCounter = 0;
-  uint8_t bitCounter = 0;
-  /* Only if the sensor was correctly initialized a reading can be done */
-  if (DHT22State == DHT22State_Init)
-  {
-    DHT22State = DHT22State_ReadInProgress;
-    /* step 1: MCU sends start signal */
-    DHT22_SetDataLineOutput();
-    DHT22_WriteDataBitLow();
-    delay_us(DHT22_MCUSendStartSignalTime);
-    DHT22_WriteDataBitHigh();
-    DHT22_SetDataLineInput();
-    /* step 2: Wait for sensor response with low pulse and high pulse */
-    waitCounter = DHT22_MCUWaitForSensorResponse;
-    while (waitCounter)
-    {
-      if (DHT22_ReadDataBit() == DHT22_DATALINE_LOW) break;
-      waitCounter--;
-    }
-    DHT22_sensorWaitCounter[0] = waitCounter;
-    if (waitCounter == 0) {
-      DHT22State = DHT22State_ReadErrorStuckAtVCC;
-      return DHT22State;
-    }
-    waitCounter = DHT22_MCUWaitForSensorResponse;
-    while (waitCounter)
-    {
-      if (DHT22_ReadDataBit() == DHT22_DATALINE_HIGH) break;
-      waitCounter--;
-    }
-    DHT22_sensorWaitCounter[1] = waitCounter;
-    if (waitCounter == 0) {
-      DHT22State = DHT22State_ReadErrorStuckAtGND;
-      return DHT22State;
-    }
-    /* step 3: wait for start of transmission and receive all bits */
-    /* to preserve byte order in union/struct we readout in oposite order from bit 39 -> 0 */
-    bitCounter = DHT22_NUMBEROFBITSFROMSENSOR;
-    while (bitCounter--)
-    {
-      waitCounter = 0;
-      /* wait for the line to go low again */
-      while (DHT22_ReadDataBit() != DHT22_DATALINE_LOW) ;
-      /* wait for the line to go high */
-      while (DHT22_ReadDataBit() != DHT22_DATALINE_HIGH) ;
-      /* now count high time */
-      while (DHT22_ReadDataBit() == DHT22_DATALINE_HIGH)
-      {
-        waitCounter++;
-      }
-#ifdef DHT22_DEBUG
-      DHT22_sensorBitWaitCounter[bitCounter] = waitCounter;
-#endif
-      DHT22_SensorValue.raw[bitCounter / 8] = DHT22_SensorValue.raw[bitCounter / 8] << 1;
-      if (waitCounter < DHT22_MCUWaitForSensorSendZero)
-      {
-        /* zero detected */
-        DHT22_SensorValue.raw[bitCounter / 8] &= 0xfe;
-      } else {
-        /* one detected */
-        DHT22_SensorValue.raw[bitCounter / 8] |= 0x01;
-      }
-    }
-    /* check CRC */
-    if (DHT22_SensorValue.raw[0] != (uint8_t)(DHT22_SensorValue.raw[1] + DHT22_SensorValue.raw[2] + DHT22_SensorValue.raw[3] + DHT22_SensorValue.raw[4]))
-    {
-      DHT22_SensorValue.values.Temperatur = DHT22_TemperaturInvalidValue;
-      DHT22_SensorValue.values.RelativeHumidity = DHT22_RelativeHumidityInvalidValue;
-      DHT22State = DHT22State_ReadErrorCRCInvalid;
-      return DHT22State;
-    }
-    /* correct negative values for temperatur */
-    if (DHT22_SensorValue.raw[4] & 0x80) DHT22_SensorValue.values.Temperatur *= -1;
-    DHT22State = DHT22State_Init;
-  }
-  return DHT22State;
-}
+/*******************| Inclusions |*************************************/
+#include "dht22.h"
+
+/*******************| Macros |*****************************************/
+/* edge counter value while the MCU is still sending the start signal */
+#define DHT22_EDGECOUNTER_STARTSIGNAL           0xff
+
+/* a new read-out may be started after init and after any finished read-out,
+ * error states included, thus a failing sensor is retried by the next call */
+#define DHT22_READALLOWED(state)                (((state) != DHT22State_Uninit) && ((state) != DHT22State_ReadInProgress))
+
+/* Hooks to arm/disarm the falling edge capture (timer capture or pin
+ * interrupt) which calls DHT22_edgeCallback. Only needed for asynchronous mode */
+#if (!defined DHT22_EnableEdgeCapture)
+#define DHT22_EnableEdgeCapture(handle)
+#endif
+#if (!defined DHT22_DisableEdgeCapture)
+#define DHT22_DisableEdgeCapture(handle)
+#endif
+
+/* Busy wait of the blocking read-out for the start signal, delay_us of the
+ * platform unless dht22_cfg.h maps it, e.g. to simulated time on the host */
+#if (!defined DHT22_DelayUs)
+#define DHT22_DelayUs(us)                       delay_us(us)
+#endif
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static uint8_t DHT22_checkFrame(DHT22_SensorValue_t *value);
+static DHT22State_t DHT22_decodeFrame(DHT22_Handle_t *handle, DHT22Mode_t mode, uint8_t defaultThreshold, DHT22State_t successState);
+static uint8_t DHT22_findThreshold(const uint8_t *width);
+static void DHT22_readStarted(DHT22_Handle_t *handle);
+static DHT22State_t DHT22_readFinished(DHT22_Handle_t *handle, DHT22State_t state);
+#ifdef DHT22_ReadDataBit
+static uint8_t DHT22_defaultReadDataBit(void);
+static void DHT22_defaultSetDataLineOutput(void);
+static void DHT22_defaultSetDataLineInput(void);
+static void DHT22_defaultWriteDataBit(uint8_t level);
+#endif
+
+/*******************| Global variables |*******************************/
+DHT22_SensorValue_t DHT22_SensorValue;
+
+#ifdef DHT22_ReadDataBit
+/**
+ * Sensor connected to the pin given by the macros in dht22_cfg.h. Used by the
+ * single sensor API (DHT22_init, DHT22_readValues, ...).
+ */
+static const DHT22_Pin_t DHT22_defaultPin = {
+  DHT22_defaultReadDataBit,
+  DHT22_defaultSetDataLineOutput,
+  DHT22_defaultSetDataLineInput,
+  DHT22_defaultWriteDataBit
+};
+static DHT22_Handle_t DHT22_defaultSensor;
+#endif
+
+/*******************| Function definition |****************************/
+/**
+ * Initialize one sensor instance and set data line to idle (high). Handle must
+ * be zero initialized before the first call, calibration and statistics are
+ * kept when the sensor is initialized again after an error.
+ * @param handle sensor instance
+ * @param pin accessor functions for the data line of this sensor
+ */
+void DHT22_initSensor(DHT22_Handle_t *handle, const DHT22_Pin_t *pin)
+{
+  handle->pin = pin;
+  handle->pin->setDataLineOutput();
+  handle->pin->writeDataBit(DHT22_DATALINE_HIGH);
+  handle->state = DHT22State_Init;
+}
+
+/*
+ * Do read-out from the sensor. Read-out will only be started if no other
+ * read-out is done right now. After an error the next call simply tries
+ * again, the start signal brings the sensor back into a known state.
+ * @param handle sensor instance
+ * @return DHT22State_Init if read-out was successfull, error state otherwise
+ */
+DHT22State_t DHT22_readSensor(DHT22_Handle_t *handle)
+{
+  const DHT22_Pin_t *pin = handle->pin;
+  uint8_t waitCounter = 0;
+  uint8_t timeoutCounter;
+  uint8_t bitCounter = 0;
+  /* Only if the sensor was initialized and is not read asynchronously a reading can be done */
+  if (DHT22_READALLOWED(handle->state))
+  {
+    DHT22_readStarted(handle);
+    /* step 1: MCU sends start signal */
+    pin->setDataLineOutput();
+    pin->writeDataBit(DHT22_DATALINE_LOW);
+    DHT22_DelayUs(DHT22_MCUSendStartSignalTime);
+    pin->writeDataBit(DHT22_DATALINE_HIGH);
+    pin->setDataLineInput();
+    /* step 2: Wait for sensor response with low pulse and high pulse */
+    waitCounter = DHT22_MCUWaitForSensorResponse;
+    while (waitCounter)
+    {
+      if (pin->readDataBit() == DHT22_DATALINE_LOW) break;
+      waitCounter--;
+    }
+#ifdef DHT22_DEBUG
+    handle->sensorWaitCounter[0] = waitCounter;
+#endif
+    if (waitCounter == 0) {
+      return DHT22_readFinished(handle, DHT22State_ReadErrorStuckAtVCC);
+    }
+    waitCounter = DHT22_MCUWaitForSensorResponse;
+    while (waitCounter)
+    {
+      if (pin->readDataBit() == DHT22_DATALINE_HIGH) break;
+      waitCounter--;
+    }
+#ifdef DHT22_DEBUG
+    handle->sensorWaitCounter[1] = waitCounter;
+#endif
+    if (waitCounter == 0) {
+      return DHT22_readFinished(handle, DHT22State_ReadErrorStuckAtGND);
+    }
+    /* step 3: wait for start of transmission and record high time of all bits,
+     * decoding is done afterwards to keep the receive loop short */
+    for (bitCounter = 0; bitCounter < DHT22_NUMBEROFBITSFROMSENSOR; bitCounter++)
+    {
+      waitCounter = 0;
+      /* low and high wait share one timeout, a sensor unplugged mid-frame must not hang us */
+      timeoutCounter = DHT22_MCUWaitForSensorResponse;
+      /* wait for the line to go low again */
+      while ((pin->readDataBit() != DHT22_DATALINE_LOW) && timeoutCounter) timeoutCounter--;
+      /* wait for the line to go high */
+      while ((pin->readDataBit() != DHT22_DATALINE_HIGH) && timeoutCounter) timeoutCounter--;
+      /* now count high time, a line stuck at high would let waitCounter wrap */
+      while ((pin->readDataBit() == DHT22_DATALINE_HIGH) && timeoutCounter)
+      {
+        if (++waitCounter == 0xff) timeoutCounter = 0;
+      }
+      if (timeoutCounter == 0)
+      {
+        return DHT22_readFinished(handle, DHT22State_ReadErrorTimeout);
+      }
+      handle->bitWidth[bitCounter] = waitCounter;
+    }
+    DHT22_readFinished(handle, DHT22_decodeFrame(handle, DHT22Mode_Blocking, DHT22_MCUWaitForSensorSendZero, DHT22State_Init));
+  }
+  return handle->state;
+}
+
+/**
+ * Start an asynchronous read-out. The data line is pulled low for the start
+ * signal, all further steps are done in DHT22_pollSensor and
+ * DHT22_sensorEdgeCallback. A read-out can be started after DHT22_initSensor
+ * or after the previous read-out finished, successful or not.
+ * @param handle sensor instance
+ * @param now current value of the timer used for edge capture
+ * @return DHT22State_ReadInProgress if read-out was started
+ */
+DHT22State_t DHT22_startSensorRead(DHT22_Handle_t *handle, uint16_t now)
+{
+  if (DHT22_READALLOWED(handle->state))
+  {
+    DHT22_readStarted(handle);
+    handle->edgeCounter = DHT22_EDGECOUNTER_STARTSIGNAL;
+    handle->readStart = now;
+    /* step 1: MCU sends start signal, will be released in DHT22_pollSensor */
+    handle->pin->setDataLineOutput();
+    handle->pin->writeDataBit(DHT22_DATALINE_LOW);
+  }
+  return handle->state;
+}
+
+/**
+ * Advance the asynchronous read-out. Must be called periodically from the main
+ * loop, never blocks. Releases the data line after the start signal, decodes
+ * the frame once all edges were captured and detects timeouts.
+ * @param handle sensor instance
+ * @param now current value of the timer used for edge capture
+ * @return DHT22State_ReadInProgress while the read-out is ongoing,
+ * DHT22State_ReadDone if handle->value was updated or the error state
+ */
+DHT22State_t DHT22_pollSensor(DHT22_Handle_t *handle, uint16_t now)
+{
+  uint16_t elapsed = now - handle->readStart;
+
+  if (handle->state != DHT22State_ReadInProgress) return handle->state;
+
+  if (handle->edgeCounter == DHT22_EDGECOUNTER_STARTSIGNAL)
+  {
+    if (elapsed >= (uint16_t)(DHT22_MCUSendStartSignalTime * DHT22_TIMERTICKSPERUS))
+    {
+      /* step 2: release data line and let DHT22_sensorEdgeCallback record the edges */
+      handle->readStart = now;
+      handle->edgeCounter = 0;
+      handle->pin->writeDataBit(DHT22_DATALINE_HIGH);
+      handle->pin->setDataLineInput();
+      DHT22_EnableEdgeCapture(handle);
+    }
+  }
+  else if (handle->edgeCounter == DHT22_NUMBEROFEDGESFROMSENSOR)
+  {
+    /* step 3: all edges captured, decode off the interrupt path */
+    DHT22_DisableEdgeCapture(handle);
+    if (elapsed > handle->statistics.maxFrameTime) handle->statistics.maxFrameTime = elapsed;
+    DHT22_readFinished(handle, DHT22_decodeFrame(handle, DHT22Mode_Asynchronous, DHT22_BITPERIODTHRESHOLD, DHT22State_ReadDone));
+  }
+  else if (elapsed > DHT22_READTIMEOUT)
+  {
+    DHT22_DisableEdgeCapture(handle);
+    if (handle->edgeCounter == 0)
+    {
+      /* sensor never answered, line level tells which way it is stuck */
+      DHT22_readFinished(handle, (handle->pin->readDataBit() == DHT22_DATALINE_LOW) ? DHT22State_ReadErrorStuckAtGND : DHT22State_ReadErrorStuckAtVCC);
+    }
+    else
+    {
+      DHT22_readFinished(handle, DHT22State_ReadErrorTimeout);
+    }
+  }
+  return handle->state;
+}
+
+/**
+ * Abort a running asynchronous read-out, e.g. one the caller gave up on as
+ * DHT22_pollSensor was not called in time. Edge capture is disarmed, the data
+ * line is set to idle (high) and the read-out counts as timed out, thus the
+ * next DHT22_startSensorRead starts a new one. Does nothing if no read-out is
+ * running.
+ * @param handle sensor instance
+ */
+void DHT22_abortSensorRead(DHT22_Handle_t *handle)
+{
+  if (handle->state != DHT22State_ReadInProgress) return;
+  DHT22_DisableEdgeCapture(handle);
+  handle->pin->setDataLineOutput();
+  handle->pin->writeDataBit(DHT22_DATALINE_HIGH);
+  DHT22_readFinished(handle, DHT22State_ReadErrorTimeout);
+}
+
+/**
+ * Must be called for every falling edge of the data line of this sensor while
+ * the edge capture is armed, i.e. from the timer input capture or pin change
+ * interrupt. Only the period since the last falling edge is stored, decoding
+ * is done in DHT22_pollSensor.
+ * @param handle sensor instance the edge belongs to
+ * @param timestamp timer value at the falling edge
+ */
+void DHT22_sensorEdgeCallback(DHT22_Handle_t *handle, uint16_t timestamp)
+{
+  uint16_t period;
+
+  if ((handle->state != DHT22State_ReadInProgress) || (handle->edgeCounter >= DHT22_NUMBEROFEDGESFROMSENSOR)) return;
+  /* first period is the sensor response, each following one is low + high time of one bit */
+  if (handle->edgeCounter >= 2)
+  {
+    period = timestamp - handle->lastEdge;
+    handle->bitWidth[handle->edgeCounter - 2] = (period > 0xff) ? 0xff : (uint8_t)period;
+  }
+  handle->lastEdge = timestamp;
+  handle->edgeCounter++;
+}
+
+/**
+ * Set bit threshold calibration of a sensor, e.g. to restore a value
+ * persisted from DHT22_getCalibration after reset.
+ * @param handle sensor instance
+ * @param mode read-out mode the threshold belongs to
+ * @param bitThreshold learned threshold, 0 to use the default of dht22_cfg.h
+ * @param enable if not 0 the thresholds of both modes are adjusted online from
+ * every frame read, if 0 the thresholds are used as is
+ */
+void DHT22_setCalibration(DHT22_Handle_t *handle, DHT22Mode_t mode, uint8_t bitThreshold, uint8_t enable)
+{
+  handle->bitThreshold[mode] = bitThreshold;
+  handle->calibrationEnabled = enable;
+}
+
+/**
+ * @param handle sensor instance
+ * @param mode read-out mode the threshold belongs to
+ * @return currently used bit threshold of the mode for persisting it, 0 if
+ * the sensor was not calibrated in this mode yet
+ */
+uint8_t DHT22_getCalibration(const DHT22_Handle_t *handle, DHT22Mode_t mode)
+{
+  return handle->bitThreshold[mode];
+}
+
+/**
+ * Get a copy of the read-out statistics of a sensor. Successful read-outs are
+ * readCounter - failedReadCounter (minus a running one).
+ * @param handle sensor instance
+ * @param statistics receives the copy
+ */
+void DHT22_readStatistics(const DHT22_Handle_t *handle, DHT22_Statistics_t *statistics)
+{
+  *statistics = handle->statistics;
+}
+
+/**
+ * Initialize scheduler for asynchronous read-out of several sensors. Sensors
+ * must already be initialized with DHT22_initSensor.
+ * @param scheduler scheduler instance
+ * @param sensors array of sensor instances
+ * @param numberOfSensors number of entries in sensors, DHT22_runScheduler does
+ * nothing if 0
+ * @param nowMs current time in ms
+ */
+void DHT22_initScheduler(DHT22_Scheduler_t *scheduler, DHT22_Handle_t *sensors, uint8_t numberOfSensors, uint16_t nowMs)
+{
+  uint8_t sensor;
+
+  scheduler->sensors = sensors;
+  scheduler->numberOfSensors = numberOfSensors;
+  /* let the first call start sensor 0, all sensors may be read right away */
+  scheduler->current = (numberOfSensors == 0) ? 0 : (uint8_t)(numberOfSensors - 1);
+  scheduler->slotStart = nowMs - DHT22_SCHEDULERSLOTTIME;
+  for (sensor = 0; sensor < numberOfSensors; sensor++)
+  {
+    sensors[sensor].lastStartMs = nowMs - DHT22_MINREADINTERVAL;
+  }
+}
+
+/**
+ * Run the scheduler, must be called periodically from the main loop. Only one
+ * sensor is read at a time and a new read-out is only started at the beginning
+ * of the next time slot. Thus, the edge interrupt load never exceeds the one of
+ * a single sensor and each sensor is read every
+ * numberOfSensors * DHT22_SCHEDULERSLOTTIME ms, but not more often than every
+ * DHT22_MINREADINTERVAL ms. Slots missed by a stalled main loop are skipped,
+ * read-outs are never started back to back.
+ * @param scheduler scheduler instance
+ * @param now current value of the timer used for edge capture
+ * @param nowMs current time in ms
+ * @return sensor whose read-out just finished (check its state) or NULL
+ */
+DHT22_Handle_t *DHT22_runScheduler(DHT22_Scheduler_t *scheduler, uint16_t now, uint16_t nowMs)
+{
+  DHT22_Handle_t *handle;
+  uint8_t next;
+
+  if (scheduler->numberOfSensors == 0) return NULL;
+  handle = &scheduler->sensors[scheduler->current];
+  if (handle->state == DHT22State_ReadInProgress)
+  {
+    if (DHT22_pollSensor(handle, now) != DHT22State_ReadInProgress) return handle;
+    return NULL;
+  }
+  if ((uint16_t)(nowMs - scheduler->slotStart) >= DHT22_SCHEDULERSLOTTIME)
+  {
+    next = scheduler->current + 1;
+    if (next >= scheduler->numberOfSensors) next = 0;
+    handle = &scheduler->sensors[next];
+    /* with few sensors the rotation waits for the sensor of the next slot */
+    if ((uint16_t)(nowMs - handle->lastStartMs) < DHT22_MINREADINTERVAL) return NULL;
+    scheduler->current = next;
+    scheduler->slotStart += DHT22_SCHEDULERSLOTTIME;
+    if ((uint16_t)(nowMs - scheduler->slotStart) >= DHT22_SCHEDULERSLOTTIME) scheduler->slotStart = nowMs;
+    handle->lastStartMs = nowMs;
+    DHT22_startSensorRead(handle, now);
+  }
+  return NULL;
+}
+
+/**
+ * Build sensor value from recorded pulse widths. Each bit is set by comparing
+ * its width against the threshold, the comparison result is shifted in
+ * directly so no branch or division is needed per bit.
+ * @param width pulse width of all DHT22_NUMBEROFBITSFROMSENSOR bits in the
+ * order received from the sensor
+ * @param threshold widths greater or equal are decoded as one
+ * @param value decoded sensor value, CRC is not checked
+ */
+void DHT22_decodeBits(const uint8_t *width, uint8_t threshold, DHT22_SensorValue_t *value)
+{
+  uint8_t byteCounter;
+  uint8_t bitCounter;
+  uint8_t byte;
+
+  /* to preserve byte order in union/struct the first byte received is stored last */
+  byteCounter = DHT22_NUMBEROFBITSFROMSENSOR / 8;
+  while (byteCounter--)
+  {
+    byte = 0;
+    for (bitCounter = 0; bitCounter < 8; bitCounter++)
+    {
+      byte = (uint8_t)(byte << 1) | (uint8_t)(*width++ >= threshold);
+    }
+    value->raw[byteCounter] = byte;
+  }
+}
+
+/**
+ * Decode a batch of recorded frames, e.g. from a trace or for off-line
+ * analysis. Frames with invalid CRC are set to the invalid values.
+ * @param width DHT22_NUMBEROFBITSFROMSENSOR pulse widths per frame, frames
+ * stored one after the other
+ * @param threshold widths greater or equal are decoded as one
+ * @param values array receiving one decoded value per frame
+ * @param numberOfFrames number of frames to decode
+ * @return number of frames with valid CRC
+ */
+uint16_t DHT22_decodeFrames(const uint8_t *width, uint8_t threshold, DHT22_SensorValue_t *values, uint16_t numberOfFrames)
+{
+  uint16_t validFrames = 0;
+
+  while (numberOfFrames--)
+  {
+    DHT22_decodeBits(width, threshold, values);
+    if (DHT22_checkFrame(values) == DHT22_OK) validFrames++;
+    width += DHT22_NUMBEROFBITSFROMSENSOR;
+    values++;
+  }
+  return validFrames;
+}
+
+/**
+ * Decode the frame in bitWidth and check its CRC. With calibration enabled the
+ * frame is decoded with the threshold learned from its own pulse widths first,
+ * which also moves the stored threshold of the mode a quarter of the way
+ * towards it, rounded so that it settles within one count. The stored (or
+ * default) threshold is used if that fails or the frame contains only one
+ * pulse length.
+ * @param handle sensor instance
+ * @param mode read-out mode the pulse widths were measured in
+ * @param defaultThreshold threshold to use if sensor is not calibrated
+ * @param successState state to return for a valid frame
+ * @return successState or DHT22State_ReadErrorCRCInvalid
+ */
+static DHT22State_t DHT22_decodeFrame(DHT22_Handle_t *handle, DHT22Mode_t mode, uint8_t defaultThreshold, DHT22State_t successState)
+{
+  uint8_t threshold = handle->bitThreshold[mode] ? handle->bitThreshold[mode] : defaultThreshold;
+  uint8_t frameThreshold;
+  sint16_t difference;
+
+  if (handle->calibrationEnabled)
+  {
+    frameThreshold = DHT22_findThreshold(handle->bitWidth);
+    if (frameThreshold)
+    {
+      DHT22_decodeBits(handle->bitWidth, frameThreshold, &handle->value);
+      if (DHT22_checkFrame(&handle->value) == DHT22_OK)
+      {
+        difference = (sint16_t)frameThreshold - threshold;
+        difference += (difference < 0) ? -2 : 2;
+        handle->bitThreshold[mode] = (uint8_t)(threshold + difference / 4);
+        return successState;
+      }
+    }
+  }
+  DHT22_decodeBits(handle->bitWidth, threshold, &handle->value);
+  if (DHT22_checkFrame(&handle->value) == DHT22_OK) return successState;
+  return DHT22State_ReadErrorCRCInvalid;
+}
+
+/**
+ * Find the split between the short (zero) and long (one) pulses of one frame.
+ * Starting in the middle between shortest and longest pulse the threshold is
+ * moved to the middle of both cluster means until it settles (2-means).
+ * @param width pulse widths of one frame
+ * @return threshold, 0 if the frame does not contain both pulse lengths
+ */
+static uint8_t DHT22_findThreshold(const uint8_t *width)
+{
+  uint16_t sum[2];
+  uint8_t count[2];
+  uint8_t minWidth = 0xff;
+  uint8_t maxWidth = 0;
+  uint8_t threshold;
+  uint8_t newThreshold;
+  uint8_t iteration;
+  uint8_t one;
+  uint8_t i;
+
+  for (i = 0; i < DHT22_NUMBEROFBITSFROMSENSOR; i++)
+  {
+    if (width[i] < minWidth) minWidth = width[i];
+    if (width[i] > maxWidth) maxWidth = width[i];
+  }
+  /* two clusters must be at least a few counts apart to be told apart */
+  if ((uint8_t)(maxWidth - minWidth) < DHT22_CALIBRATIONMINSPREAD) return 0;
+  threshold = (uint8_t)(((uint16_t)minWidth + maxWidth + 1) / 2);
+  for (iteration = 0; iteration < DHT22_CALIBRATIONITERATIONS; iteration++)
+  {
+    sum[0] = sum[1] = 0;
+    count[0] = count[1] = 0;
+    for (i = 0; i < DHT22_NUMBEROFBITSFROMSENSOR; i++)
+    {
+      one = (width[i] >= threshold);
+      sum[one] += width[i];
+      count[one]++;
+    }
+    newThreshold = (uint8_t)((sum[0] / count[0] + sum[1] / count[1] + 1) / 2);
+    if (newThreshold == threshold) break;
+    threshold = newThreshold;
+  }
+  return threshold;
+}
+
+/**
+ * Book-keeping at start of a read-out.
+ */
+static void DHT22_readStarted(DHT22_Handle_t *handle)
+{
+  handle->state = DHT22State_ReadInProgress;
+  handle->statistics.readCounter++;
+  if (handle->statistics.lastReadFailed) handle->statistics.retryCounter++;
+}
+
+/**
+ * Book-keeping at end of a read-out.
+ * @return state
+ */
+static DHT22State_t DHT22_readFinished(DHT22_Handle_t *handle, DHT22State_t state)
+{
+  handle->state = state;
+  handle->statistics.lastReadFailed = ((state != DHT22State_Init) && (state != DHT22State_ReadDone));
+  if (handle->statistics.lastReadFailed) handle->statistics.failedReadCounter++;
+  switch (state)
+  {
+    case DHT22State_ReadErrorCRCInvalid:
+      handle->statistics.crcErrorCounter++;
+      break;
+    case DHT22State_ReadErrorStuckAtVCC:
+      handle->statistics.stuckAtVCCCounter++;
+      break;
+    case DHT22State_ReadErrorStuckAtGND:
+      handle->statistics.stuckAtGNDCounter++;
+      break;
+    case DHT22State_ReadErrorTimeout:
+      handle->statistics.timeoutCounter++;
+      break;
+    default:
+      break;
+  }
+  return state;
+}
+
+/**
+ * Check CRC of the received frame and set the sensor values from it.
+ * @return DHT22_OK if CRC is valid, DHT22_NOT_OK otherwise. In this case the
+ * sensor values are set to invalid.
+ */
+static uint8_t DHT22_checkFrame(DHT22_SensorValue_t *value)
+{
+  uint16_t relativeHumidity;
+  uint16_t temperatur;
+
+  if (value->raw[0] != (uint8_t)(value->raw[1] + value->raw[2] + value->raw[3] + value->raw[4]))
+  {
+    value->values.Temperatur = DHT22_TemperaturInvalidValue;
+    value->values.RelativeHumidity = DHT22_RelativeHumidityInvalidValue;
+    return DHT22_NOT_OK;
+  }
+  /* both values are read before writing, the fields may overlap raw. Temperatur
+   * is sent in sign-magnitude format, sign is bit 7 of its high byte */
+  relativeHumidity = ((uint16_t)value->raw[4] << 8) | value->raw[3];
+  temperatur = ((uint16_t)(value->raw[2] & 0x7f) << 8) | value->raw[1];
+  value->values.RelativeHumidity = relativeHumidity;
+  value->values.Temperatur = (value->raw[2] & 0x80) ? -(sint16_t)temperatur : (sint16_t)temperatur;
+  return DHT22_OK;
+}
+
+#ifdef DHT22_ReadDataBit
+/*
+ * Single sensor API, wraps the instance API for the sensor configured in
+ * dht22_cfg.h and publishes its value in DHT22_SensorValue.
+ */
+void DHT22_init(void)
+{
+  DHT22_initSensor(&DHT22_defaultSensor, &DHT22_defaultPin);
+}
+
+DHT22State_t DHT22_readValues(void)
+{
+  DHT22State_t state = DHT22_readSensor(&DHT22_defaultSensor);
+  DHT22_SensorValue = DHT22_defaultSensor.value;
+  return state;
+}
+
+DHT22State_t DHT22_startRead(uint16_t now)
+{
+  return DHT22_startSensorRead(&DHT22_defaultSensor, now);
+}
+
+DHT22State_t DHT22_poll(uint16_t now)
+{
+  DHT22State_t state = DHT22_pollSensor(&DHT22_defaultSensor, now);
+  if (state == DHT22State_ReadDone) DHT22_SensorValue = DHT22_defaultSensor.value;
+  return state;
+}
+
+void DHT22_edgeCallback(uint16_t timestamp)
+{
+  DHT22_sensorEdgeCallback(&DHT22_defaultSensor, timestamp);
+}
+
+static uint8_t DHT22_defaultReadDataBit(void)
+{
+  return DHT22_ReadDataBit();
+}
+
+static void DHT22_defaultSetDataLineOutput(void)
+{
+  DHT22_SetDataLineOutput();
+}
+
+static void DHT22_defaultSetDataLineInput(void)
+{
+  DHT22_SetDataLineInput();
+}
+
+static void DHT22_defaultWriteDataBit(uint8_t level)
+{
+  if (level == DHT22_DATALINE_LOW)
+  {
+    DHT22_WriteDataBitLow();
+  }
+  else
+  {
+    DHT22_WriteDataBitHigh();
+  }
+}
+#endif
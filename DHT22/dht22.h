@@ -1,56 +1,236 @@
-/** @ingroup DHT22
- * @{
- */
-
-#ifndef DHT22_H_
-#define DHT22_H_
-   
-/*******************| Inclusions |*************************************/
-#include <PlatformTypes.h>
-   
-/*******************| Macros |*****************************************/
-#if (!defined DHT22_OK)
-#define DHT22_OK        0
-#endif
-
-#if (!defined DHT22_NOT_OK) 
-#define DHT22_NOT_OK    1
-#endif
-
-/* number of bits the sensor sends back */
-#define DHT22_NUMBEROFBITSFROMSENSOR            40
-   
-/*******************| Type definitions |*******************************/
-typedef enum
-{
-   DHT22State_Uninit,
-   DHT22State_Init,
-   DHT22State_ReadInProgress,
-   DHT22State_ReadErrorStuckAtVCC,
-   DHT22State_ReadErrorStuckAtGND,
-   DHT22State_ReadErrorCRCInvalid
-} DHT22State_t;
-
-/**
-* Structure to directly read out sensor values. To re-use byte order the values are
-* read out from byte 3 to byte 0.
-*/
-typedef union
-{
-  struct {
-    uint8_t CRC;
-    sint16_t Temperatur;            /*!< Operating range temperature -40~80 Celsius, resolution 0.1Celsius */
-    uint16_t RelativeHumidity;      /*!< Operating range humidity 0-100%RH, resolution 0.1%RH */
-  } values;
-  uint8_t raw[DHT22_NUMBEROFBITSFROMSENSOR / 8];
-} DHT22_SensorValue_t;
-
-/*******************| Global variables |*******************************/
-extern DHT22_SensorValue_t DHT22_SensorValue;
-
-/*******************| Function prototypes |****************************/
-void DHT22_init(void);
-DHT22State_t DHT22_readValues(void);
-
-#endif
-/** @}*/
+/** @ingroup DHT22
+ * @{
+ */
+
+#ifndef DHT22_H_
+#define DHT22_H_
+   
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+/* configuration decides on the layout of DHT22_Handle_t, thus included here */
+#include <dht22_cfg.h>
+   
+/*******************| Macros |*****************************************/
+#if (!defined DHT22_OK)
+#define DHT22_OK        0
+#endif
+
+#if (!defined DHT22_NOT_OK) 
+#define DHT22_NOT_OK    1
+#endif
+
+/* number of bits the sensor sends back */
+#define DHT22_NUMBEROFBITSFROMSENSOR            40
+
+/* number of falling edges of one frame: response, start of each bit and end of last bit */
+#define DHT22_NUMBEROFEDGESFROMSENSOR           (DHT22_NUMBEROFBITSFROMSENSOR + 2)
+
+/**
+ * Timer ticks per microsecond of the timer feeding DHT22_edgeCallback and
+ * DHT22_poll. Bit periods are stored in 8 bit, thus at most 2 ticks/us are
+ * supported.
+ */
+#if (!defined DHT22_TIMERTICKSPERUS)
+#define DHT22_TIMERTICKSPERUS                   1
+#endif
+
+/**
+ * Threshold for the period between two falling edges in asynchronous mode.
+ * A zero bit takes 50us low + 26-28us high, a one bit 50us low + 70us high.
+ */
+#if (!defined DHT22_BITPERIODTHRESHOLD)
+#define DHT22_BITPERIODTHRESHOLD                (100 * DHT22_TIMERTICKSPERUS)
+#endif
+
+/**
+ * Maximum time in timer ticks from releasing the data line until the complete
+ * frame was received in asynchronous mode. A frame takes about 5ms.
+ */
+#if (!defined DHT22_READTIMEOUT)
+#define DHT22_READTIMEOUT                       (10000 * DHT22_TIMERTICKSPERUS)
+#endif
+
+/**
+ * Minimum difference between shortest and longest pulse of a frame for bit
+ * threshold calibration, and maximum number of iterations to find the split.
+ */
+#if (!defined DHT22_CALIBRATIONMINSPREAD)
+#define DHT22_CALIBRATIONMINSPREAD              4
+#endif
+#if (!defined DHT22_CALIBRATIONITERATIONS)
+#define DHT22_CALIBRATIONITERATIONS             4
+#endif
+
+/**
+ * Length of one scheduler time slot in ms. Only one sensor is read per slot.
+ */
+#if (!defined DHT22_SCHEDULERSLOTTIME)
+#define DHT22_SCHEDULERSLOTTIME                 500
+#endif
+
+/**
+ * The DHT22 must not be read more often than every 2s (in ms). The scheduler
+ * waits before the next slot if the sensor of that slot is not ready yet.
+ */
+#if (!defined DHT22_MINREADINTERVAL)
+#define DHT22_MINREADINTERVAL                   2000
+#endif
+
+/* Configuration is checked here, timings are kept in 8 bit loop counters and
+ * bit periods as well as 16 bit timer differences */
+#if (DHT22_TIMERTICKSPERUS < 1) || (DHT22_TIMERTICKSPERUS > 2)
+#error "DHT22_TIMERTICKSPERUS must be 1..2, a one bit (120us) must fit into 8 bit"
+#endif
+#if (DHT22_BITPERIODTHRESHOLD <= 78 * DHT22_TIMERTICKSPERUS) || (DHT22_BITPERIODTHRESHOLD >= 120 * DHT22_TIMERTICKSPERUS)
+#error "DHT22_BITPERIODTHRESHOLD must be between zero bit (78us) and one bit (120us) period"
+#endif
+#if (DHT22_READTIMEOUT > 0xffff) || (DHT22_MCUSendStartSignalTime * DHT22_TIMERTICKSPERUS > 0xffff)
+#error "DHT22_READTIMEOUT and DHT22_MCUSendStartSignalTime must fit into 16 bit timer ticks"
+#endif
+#if (DHT22_MCUWaitForSensorResponse > 0xff) || (DHT22_MCUWaitForSensorSendZero > 0xff)
+#error "DHT22_MCUWaitForSensorResponse and DHT22_MCUWaitForSensorSendZero are 8 bit loop counts"
+#endif
+#if (DHT22_SCHEDULERSLOTTIME < 1) || (DHT22_SCHEDULERSLOTTIME > 0x7fff) || (DHT22_MINREADINTERVAL > 0x7fff)
+#error "DHT22_SCHEDULERSLOTTIME must be 1..32767ms, DHT22_MINREADINTERVAL at most 32767ms"
+#endif
+
+/*******************| Type definitions |*******************************/
+typedef enum
+{
+   DHT22State_Uninit,
+   DHT22State_Init,
+   DHT22State_ReadInProgress,
+   DHT22State_ReadErrorStuckAtVCC,
+   DHT22State_ReadErrorStuckAtGND,
+   DHT22State_ReadErrorCRCInvalid,
+   DHT22State_ReadDone,               /*!< asynchronous read finished, DHT22_SensorValue is valid */
+   DHT22State_ReadErrorTimeout        /*!< sensor stopped sending in the middle of a frame */
+} DHT22State_t;
+
+/**
+ * Read-out modes. Pulse widths are measured in different units, loop counts of
+ * the high time in blocking mode and timer ticks of the bit period in
+ * asynchronous mode, so each mode has its own bit threshold.
+ */
+typedef enum
+{
+   DHT22Mode_Blocking,
+   DHT22Mode_Asynchronous,
+   DHT22Mode_Count
+} DHT22Mode_t;
+
+/**
+* Structure to directly read out sensor values. The frame is received into raw, the
+* first byte received is stored last. After the CRC check the values are assigned
+* from raw explicitly: on the 8051 (no padding, little endian) they overlay raw
+* anyway, compilers padding after CRC (e.g. on a host) would read garbage. Thus
+* raw is only valid until the frame was checked.
+*/
+typedef union
+{
+  struct {
+    uint8_t CRC;
+    sint16_t Temperatur;            /*!< Operating range temperature -40~80 Celsius, resolution 0.1Celsius */
+    uint16_t RelativeHumidity;      /*!< Operating range humidity 0-100%RH, resolution 0.1%RH */
+  } values;
+  uint8_t raw[DHT22_NUMBEROFBITSFROMSENSOR / 8];
+} DHT22_SensorValue_t;
+
+/**
+ * Read-out statistics of one sensor, always enabled. Counters are only
+ * updated from the main loop, see DHT22_readStatistics.
+ */
+typedef struct
+{
+  uint16_t readCounter;                         /*!< read-outs started */
+  uint16_t failedReadCounter;                   /*!< read-outs ending in an error state */
+  uint16_t retryCounter;                        /*!< read-outs started after a failed one */
+  uint16_t crcErrorCounter;                     /*!< read-outs ending in DHT22State_ReadErrorCRCInvalid */
+  uint16_t stuckAtVCCCounter;                   /*!< read-outs ending in DHT22State_ReadErrorStuckAtVCC */
+  uint16_t stuckAtGNDCounter;                   /*!< read-outs ending in DHT22State_ReadErrorStuckAtGND */
+  uint16_t timeoutCounter;                      /*!< read-outs ending in DHT22State_ReadErrorTimeout */
+  uint16_t maxFrameTime;                        /*!< asynchronous mode: longest time from releasing the data line until frame complete in timer ticks */
+  uint8_t lastReadFailed;
+} DHT22_Statistics_t;
+
+/**
+ * Accessor functions for the data line of one sensor.
+ */
+typedef struct
+{
+  uint8_t (*readDataBit)(void);                 /*!< return DHT22_DATALINE_LOW or DHT22_DATALINE_HIGH */
+  void (*setDataLineOutput)(void);
+  void (*setDataLineInput)(void);
+  void (*writeDataBit)(uint8_t level);          /*!< level DHT22_DATALINE_LOW or DHT22_DATALINE_HIGH */
+} DHT22_Pin_t;
+
+/**
+ * Context of one sensor. RAM cost per instance is 72 bytes plus the
+ * pin pointer and the state enum, DHT22_DEBUG adds 4 bytes for the wait
+ * counters. The pin accessors are const and can be placed in code memory.
+ */
+typedef struct
+{
+  const DHT22_Pin_t *pin;
+  DHT22State_t state;
+  DHT22_SensorValue_t value;                    /*!< last value read from the sensor */
+  volatile uint8_t edgeCounter;                 /*!< asynchronous mode: falling edges received so far */
+  uint16_t lastEdge;                            /*!< asynchronous mode: time stamp of last falling edge */
+  uint16_t readStart;                           /*!< asynchronous mode: start of current read-out phase */
+  /**
+   * Pulse width of every bit in the order received: high time loop count in
+   * blocking mode, period between falling edges in timer ticks in asynchronous
+   * mode. Decoded by DHT22_decodeBits once the frame is complete.
+   */
+  uint8_t bitWidth[DHT22_NUMBEROFBITSFROMSENSOR];
+  uint8_t bitThreshold[DHT22Mode_Count];        /*!< learned bit threshold per mode, 0 if not calibrated */
+  uint8_t calibrationEnabled;
+  uint16_t lastStartMs;                         /*!< scheduler: start of the last read-out in ms */
+  DHT22_Statistics_t statistics;
+#ifdef DHT22_DEBUG
+  /**
+   * Wait counters for the sensor response. Together with bitWidth these values
+   * can be used to match your MCU to the sensor and helps to configure the
+   * values in dht22_cfg.h
+   */
+  uint16_t sensorWaitCounter[2];
+#endif
+} DHT22_Handle_t;
+
+/**
+ * Round robin read-out of several sensors, see DHT22_runScheduler.
+ */
+typedef struct
+{
+  DHT22_Handle_t *sensors;
+  uint8_t numberOfSensors;
+  uint8_t current;                              /*!< sensor of the current time slot */
+  uint16_t slotStart;                           /*!< start of current time slot in ms */
+} DHT22_Scheduler_t;
+
+/*******************| Global variables |*******************************/
+extern DHT22_SensorValue_t DHT22_SensorValue;
+
+/*******************| Function prototypes |****************************/
+void DHT22_init(void);
+DHT22State_t DHT22_readValues(void);
+DHT22State_t DHT22_startRead(uint16_t now);
+DHT22State_t DHT22_poll(uint16_t now);
+void DHT22_edgeCallback(uint16_t timestamp);
+
+void DHT22_initSensor(DHT22_Handle_t *handle, const DHT22_Pin_t *pin);
+DHT22State_t DHT22_readSensor(DHT22_Handle_t *handle);
+DHT22State_t DHT22_startSensorRead(DHT22_Handle_t *handle, uint16_t now);
+DHT22State_t DHT22_pollSensor(DHT22_Handle_t *handle, uint16_t now);
+void DHT22_abortSensorRead(DHT22_Handle_t *handle);
+void DHT22_sensorEdgeCallback(DHT22_Handle_t *handle, uint16_t timestamp);
+void DHT22_decodeBits(const uint8_t *width, uint8_t threshold, DHT22_SensorValue_t *value);
+uint16_t DHT22_decodeFrames(const uint8_t *width, uint8_t threshold, DHT22_SensorValue_t *values, uint16_t numberOfFrames);
+void DHT22_initScheduler(DHT22_Scheduler_t *scheduler, DHT22_Handle_t *sensors, uint8_t numberOfSensors, uint16_t nowMs);
+void DHT22_setCalibration(DHT22_Handle_t *handle, DHT22Mode_t mode, uint8_t bitThreshold, uint8_t enable);
+uint8_t DHT22_getCalibration(const DHT22_Handle_t *handle, DHT22Mode_t mode);
+void DHT22_readStatistics(const DHT22_Handle_t *handle, DHT22_Statistics_t *statistics);
+DHT22_Handle_t *DHT22_runScheduler(DHT22_Scheduler_t *scheduler, uint16_t now, uint16_t nowMs);
+
+#endif
+/** @}*/
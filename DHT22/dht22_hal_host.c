@@ -0,0 +1,312 @@
+/*******************| Inclusions |*************************************/
+#include "dht22_hal_host.h"
+
+#ifdef DHT22_HAL_HOST
+/*******************| Macros |*****************************************/
+/* Accessor functions of one simulated line for DHT22_hostPin */
+#define DHT22_HOSTPINFUNCTIONS(line) \
+  static uint8_t DHT22_hostReadDataBit##line(void) { return DHT22_hostReadLine(line); } \
+  static void DHT22_hostSetDataLineOutput##line(void) { DHT22_hostSetOutput(line, 1); } \
+  static void DHT22_hostSetDataLineInput##line(void) { DHT22_hostSetOutput(line, 0); } \
+  static void DHT22_hostWriteDataBit##line(uint8_t level) { DHT22_hostWriteLine(line, level); }
+
+#define DHT22_HOSTPIN(line) \
+  { DHT22_hostReadDataBit##line, DHT22_hostSetDataLineOutput##line, DHT22_hostSetDataLineInput##line, DHT22_hostWriteDataBit##line }
+
+/*******************| Type definitions |*******************************/
+/**
+ * One simulated data line with its sensor
+ */
+typedef struct
+{
+  uint32_t toggle[DHT22_HOSTMAXTOGGLES];        /*!< response: level changes in us after release of the start signal, line starts high */
+  uint16_t numberOfToggles;
+  uint16_t position;                            /*!< level changes of the running response passed so far */
+  uint32_t releaseTime;                         /*!< end of the last start signal */
+  uint32_t lowStart;                            /*!< time the MCU started to pull the line low */
+  uint8_t output;                               /*!< MCU drives the line */
+  uint8_t outputLevel;
+  uint8_t responding;                           /*!< sensor answers the last start signal */
+  DHT22_Handle_t *captureHandle;                /*!< handle with armed edge capture, NULL if disarmed */
+} DHT22_hostLine_t;
+
+/*******************| Function prototypes |****************************/
+static void DHT22_hostDrive(uint8_t line, uint8_t output, uint8_t outputLevel);
+static DHT22_hostLine_t *DHT22_hostCaptureLine(void *handle);
+
+/*******************| Global variables |*******************************/
+uint32_t DHT22_hostTime;
+
+static DHT22_hostLine_t DHT22_hostLine[DHT22_HOSTNUMBEROFLINES];
+
+/**
+ * State of the jitter generator of DHT22_hostReplay, fixed seed keeps replays
+ * reproducible
+ */
+static uint32_t DHT22_hostRandomState;
+
+DHT22_HOSTPINFUNCTIONS(0)
+DHT22_HOSTPINFUNCTIONS(1)
+DHT22_HOSTPINFUNCTIONS(2)
+DHT22_HOSTPINFUNCTIONS(3)
+
+const DHT22_Pin_t DHT22_hostPin[DHT22_HOSTNUMBEROFLINES] = {
+  DHT22_HOSTPIN(0),
+  DHT22_HOSTPIN(1),
+  DHT22_HOSTPIN(2),
+  DHT22_HOSTPIN(3)
+};
+
+/*******************| Function definition |****************************/
+/**
+ * Reset simulated time and all lines: idle (pulled up), capture disarmed and
+ * no sensor response, i.e. a sensor stuck at VCC.
+ */
+void DHT22_hostInit(void)
+{
+  uint8_t line;
+
+  DHT22_hostTime = 0;
+  DHT22_hostRandomState = 1;
+  for (line = 0; line < DHT22_HOSTNUMBEROFLINES; line++)
+  {
+    DHT22_hostLine[line].numberOfToggles = 0;
+    DHT22_hostLine[line].position = 0;
+    DHT22_hostLine[line].output = 0;
+    DHT22_hostLine[line].outputLevel = DHT22_DATALINE_HIGH;
+    DHT22_hostLine[line].responding = 0;
+    DHT22_hostLine[line].captureHandle = NULL;
+  }
+}
+
+/**
+ * Set the response of the sensor on a line, used for every following start
+ * signal. No level change gives a sensor stuck at VCC, a single one at 0 a
+ * sensor stuck at GND.
+ * @param line simulated line
+ * @param toggles times of the level changes in us after the end of the start
+ * signal, ascending, the line starts high
+ * @param numberOfToggles number of level changes, at most DHT22_HOSTMAXTOGGLES
+ */
+void DHT22_hostSetResponse(uint8_t line, const uint32_t *toggles, uint16_t numberOfToggles)
+{
+  uint16_t toggle;
+
+  if (numberOfToggles > DHT22_HOSTMAXTOGGLES) numberOfToggles = DHT22_HOSTMAXTOGGLES;
+  for (toggle = 0; toggle < numberOfToggles; toggle++)
+  {
+    DHT22_hostLine[line].toggle[toggle] = toggles[toggle];
+  }
+  DHT22_hostLine[line].numberOfToggles = numberOfToggles;
+  DHT22_hostLine[line].responding = 0;
+}
+
+/**
+ * Generate the response of an ideal sensor with the timing given by
+ * DHT22_HOSTxxxTIME.
+ * @param relativeHumidity relative humidity in 0.1%RH
+ * @param temperature temperature in 0.1Celsius, sent in sign-magnitude format
+ * @param toggles receives DHT22_HOSTFRAMETOGGLES level changes
+ * @return number of level changes
+ */
+uint16_t DHT22_hostEncodeFrame(uint16_t relativeHumidity, sint16_t temperature, uint32_t *toggles)
+{
+  uint8_t frame[DHT22_NUMBEROFBITSFROMSENSOR / 8];
+  uint16_t magnitude = (uint16_t)((temperature < 0) ? -temperature : temperature);
+  uint32_t time = DHT22_HOSTRESPONSEDELAY;
+  uint16_t count = 0;
+  uint8_t bit;
+
+  frame[0] = (uint8_t)(relativeHumidity >> 8);
+  frame[1] = (uint8_t)relativeHumidity;
+  frame[2] = (uint8_t)((magnitude >> 8) & 0x7f) | (uint8_t)((temperature < 0) ? 0x80 : 0);
+  frame[3] = (uint8_t)magnitude;
+  frame[4] = (uint8_t)(frame[0] + frame[1] + frame[2] + frame[3]);
+  /* response low and high */
+  toggles[count++] = time;
+  time += DHT22_HOSTRESPONSETIME;
+  toggles[count++] = time;
+  time += DHT22_HOSTRESPONSETIME;
+  /* each bit is low for the same time, the high time tells zero from one */
+  for (bit = 0; bit < DHT22_NUMBEROFBITSFROMSENSOR; bit++)
+  {
+    toggles[count++] = time;
+    time += DHT22_HOSTBITLOWTIME;
+    toggles[count++] = time;
+    time += (frame[bit / 8] & (0x80 >> (bit % 8))) ? DHT22_HOSTONEHIGHTIME : DHT22_HOSTZEROHIGHTIME;
+  }
+  /* end of the last bit, sensor releases the line */
+  toggles[count++] = time;
+  time += DHT22_HOSTBITLOWTIME;
+  toggles[count++] = time;
+  return count;
+}
+
+/**
+ * @return simulated time in timer ticks, the timer of DHT22_startSensorRead,
+ * DHT22_pollSensor and the edge capture
+ */
+uint16_t DHT22_hostReadTimer(void)
+{
+  return (uint16_t)(DHT22_hostTime * DHT22_TIMERTICKSPERUS);
+}
+
+/**
+ * Let simulated time advance. Level changes of all sensors up to the given
+ * time are played in time order, falling edges are passed to
+ * DHT22_sensorEdgeCallback of the handle which armed the capture of the line.
+ * @param time simulated time in us
+ */
+void DHT22_hostRunUntil(uint32_t time)
+{
+  DHT22_hostLine_t *line;
+  DHT22_hostLine_t *next;
+  uint32_t nextTime;
+  uint32_t toggleTime;
+  uint8_t index;
+
+  for (;;)
+  {
+    next = NULL;
+    nextTime = time;
+    for (index = 0; index < DHT22_HOSTNUMBEROFLINES; index++)
+    {
+      line = &DHT22_hostLine[index];
+      if (!line->responding || (line->position >= line->numberOfToggles)) continue;
+      toggleTime = line->releaseTime + line->toggle[line->position];
+      if ((toggleTime <= nextTime) && ((next == NULL) || (toggleTime < nextTime)))
+      {
+        next = line;
+        nextTime = toggleTime;
+      }
+    }
+    if (next == NULL) break;
+    if (nextTime > DHT22_hostTime) DHT22_hostTime = nextTime;
+    /* the line starts high, every even level change is a falling edge. A
+     * change right at the release is none, the line never went high */
+    if (!(next->position & 0x01) && (next->toggle[next->position] != 0) && (next->captureHandle != NULL))
+    {
+      DHT22_sensorEdgeCallback(next->captureHandle, DHT22_hostReadTimer());
+    }
+    next->position++;
+  }
+  if (time > DHT22_hostTime) DHT22_hostTime = time;
+}
+
+/**
+ * Replay the falling edges of a recorded frame, e.g. a logic analyzer trace of
+ * the data line, through DHT22_sensorEdgeCallback. Edges are only delivered
+ * while the handle has the capture armed, i.e. after its asynchronous read-out
+ * released the data line, trace timestamps are relative to that moment.
+ * Timestamps are distorted by Trace_distortTimestamp. The edge interrupt reads
+ * the timer itself, thus latency delays the timestamp as well. Simulated time
+ * advances to the last edge.
+ * @param handle sensor instance
+ * @param trace edges sorted by timestamp
+ * @param numberOfEvents number of edges
+ * @param channel trace channel of the data line
+ * @param distortion skew, jitter and latency, may be NULL for an exact replay
+ */
+void DHT22_hostReplay(DHT22_Handle_t *handle, const Trace_Event_t *trace, uint16_t numberOfEvents, uint8_t channel, const Trace_Distortion_t *distortion)
+{
+  uint32_t start = DHT22_hostTime;
+  uint32_t time;
+
+  for (; numberOfEvents; numberOfEvents--, trace++)
+  {
+    if ((trace->channel != channel) || trace->level) continue;
+    time = start + Trace_distortTimestamp(distortion, trace->timestamp, &DHT22_hostRandomState);
+    if (distortion != NULL) time += distortion->latency;
+    if (time < DHT22_hostTime) time = DHT22_hostTime;
+    DHT22_hostRunUntil(time);
+    if (DHT22_hostCaptureLine(handle)->captureHandle == handle) DHT22_sensorEdgeCallback(handle, DHT22_hostReadTimer());
+  }
+}
+
+/**
+ * Busy wait of the driver, see DHT22_DelayUs
+ */
+void DHT22_hostDelay(uint16_t us)
+{
+  DHT22_hostRunUntil(DHT22_hostTime + us);
+}
+
+/**
+ * Read a line, takes DHT22_HOSTREADTIME. The MCU pulling low wins, otherwise
+ * the sensor response (or the pull-up) gives the level.
+ * @return DHT22_DATALINE_LOW or DHT22_DATALINE_HIGH
+ */
+uint8_t DHT22_hostReadLine(uint8_t line)
+{
+  DHT22_hostLine_t *hostLine = &DHT22_hostLine[line];
+
+  DHT22_hostRunUntil(DHT22_hostTime + DHT22_HOSTREADTIME);
+  if (hostLine->output && (hostLine->outputLevel == DHT22_DATALINE_LOW)) return DHT22_DATALINE_LOW;
+  if (hostLine->responding && (hostLine->position & 0x01)) return DHT22_DATALINE_LOW;
+  return DHT22_DATALINE_HIGH;
+}
+
+void DHT22_hostSetOutput(uint8_t line, uint8_t output)
+{
+  DHT22_hostDrive(line, output, DHT22_hostLine[line].outputLevel);
+}
+
+void DHT22_hostWriteLine(uint8_t line, uint8_t level)
+{
+  DHT22_hostDrive(line, DHT22_hostLine[line].output, level);
+}
+
+/**
+ * Edge capture hooks, see DHT22_EnableEdgeCapture
+ */
+void DHT22_hostEnableCapture(void *handle)
+{
+  DHT22_hostCaptureLine(handle)->captureHandle = (DHT22_Handle_t *)handle;
+}
+
+void DHT22_hostDisableCapture(void *handle)
+{
+  DHT22_hostCaptureLine(handle)->captureHandle = NULL;
+}
+
+/**
+ * Change what the MCU drives. The end of a low phase of at least
+ * DHT22_HOSTMINSTARTSIGNAL is a start signal and starts the sensor response,
+ * pulling low stops it.
+ */
+static void DHT22_hostDrive(uint8_t line, uint8_t output, uint8_t outputLevel)
+{
+  DHT22_hostLine_t *hostLine = &DHT22_hostLine[line];
+  uint8_t wasLow = hostLine->output && (hostLine->outputLevel == DHT22_DATALINE_LOW);
+  uint8_t isLow = output && (outputLevel == DHT22_DATALINE_LOW);
+
+  hostLine->output = output;
+  hostLine->outputLevel = outputLevel;
+  if (!wasLow && isLow)
+  {
+    hostLine->lowStart = DHT22_hostTime;
+    hostLine->responding = 0;
+  }
+  else if (wasLow && !isLow && ((DHT22_hostTime - hostLine->lowStart) >= DHT22_HOSTMINSTARTSIGNAL))
+  {
+    hostLine->releaseTime = DHT22_hostTime;
+    hostLine->position = 0;
+    hostLine->responding = 1;
+  }
+}
+
+/**
+ * Line of a handle. Handles of the single sensor API do not use
+ * DHT22_hostPin but the cfg macros, i.e. line 0.
+ */
+static DHT22_hostLine_t *DHT22_hostCaptureLine(void *handle)
+{
+  uint8_t line;
+
+  for (line = 0; line < DHT22_HOSTNUMBEROFLINES; line++)
+  {
+    if (((DHT22_Handle_t *)handle)->pin == &DHT22_hostPin[line]) return &DHT22_hostLine[line];
+  }
+  return &DHT22_hostLine[0];
+}
+#endif
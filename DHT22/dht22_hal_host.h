@@ -0,0 +1,63 @@
+/** @ingroup DHT22
+ * @{
+ */
+
+#ifndef DHT22_HAL_HOST_H_
+#define DHT22_HAL_HOST_H_
+
+/**
+ * Host backend for DHT22 module. Up to DHT22_HOSTNUMBEROFLINES data lines with
+ * one simulated sensor each are provided, DHT22_hostPin[n] accesses line n and
+ * the single sensor API uses line 0 (see Platform/Host/dht22_cfg.h). Time only
+ * advances when the driver reads a line (DHT22_HOSTREADTIME per read) or
+ * waits, and through DHT22_hostRunUntil. A sensor answers a start signal of at
+ * least DHT22_HOSTMINSTARTSIGNAL us with its response, e.g. a frame from
+ * DHT22_hostEncodeFrame. While a handle has the edge capture armed, falling
+ * edges of its line are delivered to DHT22_sensorEdgeCallback. Thus blocking
+ * and asynchronous read-outs run deterministically on a PC. DHT22_hostReplay
+ * feeds a recorded trace (see trace.h) into an asynchronous read-out instead,
+ * with optional clock skew, jitter and interrupt latency.
+*/
+
+/*******************| Inclusions |*************************************/
+#include "dht22.h"
+#include "trace.h"
+
+/*******************| Macros |*****************************************/
+#define DHT22_HOSTNUMBEROFLINES                 4
+
+/* simulated time per read of a line in us, i.e. per wait loop iteration */
+#define DHT22_HOSTREADTIME                      1
+
+/* shortest start signal the simulated sensor answers, datasheet: at least 1ms */
+#define DHT22_HOSTMINSTARTSIGNAL                1000
+
+/* maximum number of level changes of one response */
+#define DHT22_HOSTMAXTOGGLES                    128
+
+/* Timing of DHT22_hostEncodeFrame in us: response delay after release of the
+ * line, response low and high time, low time of a bit, high time of a zero and
+ * of a one bit. A frame consists of DHT22_HOSTFRAMETOGGLES level changes. */
+#define DHT22_HOSTRESPONSEDELAY                 30
+#define DHT22_HOSTRESPONSETIME                  80
+#define DHT22_HOSTBITLOWTIME                    50
+#define DHT22_HOSTZEROHIGHTIME                  26
+#define DHT22_HOSTONEHIGHTIME                   70
+#define DHT22_HOSTFRAMETOGGLES                  (2 * DHT22_NUMBEROFBITSFROMSENSOR + 4)
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Global variables |*******************************/
+extern uint32_t DHT22_hostTime;                 /*!< simulated time in us */
+extern const DHT22_Pin_t DHT22_hostPin[DHT22_HOSTNUMBEROFLINES];
+
+/*******************| Function prototypes |****************************/
+void DHT22_hostInit(void);
+void DHT22_hostSetResponse(uint8_t line, const uint32_t *toggles, uint16_t numberOfToggles);
+uint16_t DHT22_hostEncodeFrame(uint16_t relativeHumidity, sint16_t temperature, uint32_t *toggles);
+uint16_t DHT22_hostReadTimer(void);
+void DHT22_hostRunUntil(uint32_t time);
+void DHT22_hostReplay(DHT22_Handle_t *handle, const Trace_Event_t *trace, uint16_t numberOfEvents, uint8_t channel, const Trace_Distortion_t *distortion);
+
+#endif
+/** @}*/
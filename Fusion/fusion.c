@@ -0,0 +1,115 @@
+/*******************| Inclusions |*************************************/
+#include "fusion.h"
+
+/**
+ * @brief Humidity compensation of optical particle readings
+ * Particles take up water at high humidity and appear larger, optical sensors
+ * (PPD42NS, GP2Y1050) thus read too high. The growth of the particle mass is
+ * estimated from the relative humidity of the DHT22 with kappa-Koehler theory
+ *   C = 1 + (kappa / 1.65) / (1 / aw - 1), aw = RH / 100%
+ * and the reading is divided by C. Everything is done in fixed point, one
+ * division for the growth factor and one for its inverse per value.
+ * Humidity and particle readings carry timestamps of the same time base,
+ * readings too far apart are passed through uncorrected and flagged.
+*/
+
+/*******************| Macros |*****************************************/
+/* 1 / 1.65 in Q8 */
+#define FUSION_INVERSEDENSITYRATIO              155
+
+/* 100%RH in 0.1%RH */
+#define FUSION_FULLHUMIDITY                     1000
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+/**
+ * Initialize fusion instance, no humidity is known afterwards.
+ * @param fusion fusion instance
+ * @param config configuration, may be NULL to use FUSION_DEFAULTKAPPA,
+ * FUSION_DEFAULTMAXHUMIDITY and FUSION_DEFAULTMAXAGE
+ */
+void Fusion_init(Fusion_t *fusion, const Fusion_Config_t *config)
+{
+  fusion->config.kappa = FUSION_DEFAULTKAPPA;
+  fusion->config.maxHumidity = FUSION_DEFAULTMAXHUMIDITY;
+  fusion->config.maxAge = FUSION_DEFAULTMAXAGE;
+  if (config != NULL)
+  {
+    fusion->config.kappa = config->kappa;
+    if (config->maxHumidity < FUSION_FULLHUMIDITY) fusion->config.maxHumidity = config->maxHumidity;
+    fusion->config.maxAge = config->maxAge;
+  }
+  fusion->humidityValid = 0;
+}
+
+/**
+ * Provide a new humidity reading, e.g. after a DHT22 read-out.
+ * @param fusion fusion instance
+ * @param relativeHumidity relative humidity in 0.1%RH, values above 100%RH
+ * (e.g. DHT22_RelativeHumidityInvalidValue) mark a failed read-out
+ * @param timestamp time of the reading
+ */
+void Fusion_setHumidity(Fusion_t *fusion, uint16_t relativeHumidity, uint32_t timestamp)
+{
+  if (relativeHumidity > FUSION_FULLHUMIDITY)
+  {
+    fusion->humidityValid = 0;
+    return;
+  }
+  fusion->relativeHumidity = relativeHumidity;
+  fusion->humidityTimestamp = timestamp;
+  fusion->humidityValid = 1;
+}
+
+/**
+ * Correct one particle reading with the humidity reading closest in time.
+ * @param fusion fusion instance
+ * @param value particle reading, any unit (particle/m^3, ug/m^3)
+ * @param timestamp time of the particle reading
+ * @param inputStatus status of the particle reading, 0 if fine (e.g. PPD42NS
+ * snapshot flags)
+ * @param corrected corrected value in the unit of value
+ * @return FUSION_QUALITY_xxx flags
+ */
+uint8_t Fusion_correct(const Fusion_t *fusion, uint32_t value, uint32_t timestamp, uint8_t inputStatus, uint32_t *corrected)
+{
+  uint8_t quality = inputStatus ? FUSION_QUALITY_INPUTERROR : FUSION_QUALITY_OK;
+  uint16_t relativeHumidity = fusion->relativeHumidity;
+  uint32_t age = timestamp - fusion->humidityTimestamp;
+  uint32_t inverse;
+
+  *corrected = value;
+  if (!fusion->humidityValid) return quality | FUSION_QUALITY_NOHUMIDITY;
+  /* humidity may be taken shortly after the particle reading */
+  if ((age > fusion->config.maxAge) && ((uint32_t)-age > fusion->config.maxAge)) return quality | FUSION_QUALITY_STALEHUMIDITY;
+  if (relativeHumidity > fusion->config.maxHumidity)
+  {
+    relativeHumidity = fusion->config.maxHumidity;
+    quality |= FUSION_QUALITY_HUMIDITYLIMIT;
+  }
+  /* 1 / C in Q16, 1.0 down to 1/604, split value to stay within 32 bit */
+  inverse = ((uint32_t)1 << 24) / Fusion_growthFactor(fusion->config.kappa, relativeHumidity);
+  *corrected = (value >> 16) * inverse + (((value & 0xffff) * inverse) >> 16);
+  return quality;
+}
+
+/**
+ * Mass growth factor C of kappa-Koehler theory.
+ * @param kappa hygroscopicity in Q8
+ * @param relativeHumidity relative humidity in 0.1%RH, 100%RH and above are
+ * taken as 99.9%RH
+ * @return growth factor in Q8, 1.0 up to 604 (kappa 255 at 99.9%RH), i.e.
+ * beyond 16 bit
+ */
+uint32_t Fusion_growthFactor(uint8_t kappa, uint16_t relativeHumidity)
+{
+  if (relativeHumidity >= FUSION_FULLHUMIDITY) relativeHumidity = FUSION_FULLHUMIDITY - 1;
+  /* kappa / 1.65 * aw / (1 - aw) with aw / (1 - aw) = RH / (100% - RH),
+   * numerator at most 255 * 155 * 999 */
+  return 0x100 + ((uint32_t)kappa * FUSION_INVERSEDENSITYRATIO * relativeHumidity) / ((uint32_t)(FUSION_FULLHUMIDITY - relativeHumidity) << 8);
+}
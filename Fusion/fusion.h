@@ -0,0 +1,67 @@
+/** @ingroup Fusion
+ * @{
+ */
+
+#ifndef FUSION_H_
+#define FUSION_H_
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+/**
+ * Default hygroscopicity kappa in Q8, 0.4 is typical for urban aerosol seen
+ * by low cost optical sensors.
+ */
+#if (!defined FUSION_DEFAULTKAPPA)
+#define FUSION_DEFAULTKAPPA                     102
+#endif
+
+/**
+ * Default humidity limit in 0.1%RH. Growth diverges towards 100%RH (fog), above
+ * the limit the correction uses the limit.
+ */
+#if (!defined FUSION_DEFAULTMAXHUMIDITY)
+#define FUSION_DEFAULTMAXHUMIDITY               950
+#endif
+
+/**
+ * Default maximum age of the humidity reading in units of the timestamps
+ */
+#if (!defined FUSION_DEFAULTMAXAGE)
+#define FUSION_DEFAULTMAXAGE                    600
+#endif
+
+/* Quality flags of a corrected value */
+#define FUSION_QUALITY_OK                       0x00
+#define FUSION_QUALITY_NOHUMIDITY               0x01  /*!< no valid humidity reading, value not corrected */
+#define FUSION_QUALITY_STALEHUMIDITY            0x02  /*!< humidity reading too old, value not corrected */
+#define FUSION_QUALITY_HUMIDITYLIMIT            0x04  /*!< humidity above limit, correction is too small */
+#define FUSION_QUALITY_INPUTERROR               0x08  /*!< particle sensor reported an error */
+
+/*******************| Type definitions |*******************************/
+typedef struct
+{
+  uint8_t kappa;                                /*!< hygroscopicity in Q8 */
+  uint16_t maxHumidity;                         /*!< humidity limit in 0.1%RH, below 1000 */
+  uint32_t maxAge;                              /*!< maximum age of humidity reading */
+} Fusion_Config_t;
+
+typedef struct
+{
+  Fusion_Config_t config;
+  uint16_t relativeHumidity;                    /*!< last valid reading in 0.1%RH */
+  uint32_t humidityTimestamp;
+  uint8_t humidityValid;
+} Fusion_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+void Fusion_init(Fusion_t *fusion, const Fusion_Config_t *config);
+void Fusion_setHumidity(Fusion_t *fusion, uint16_t relativeHumidity, uint32_t timestamp);
+uint8_t Fusion_correct(const Fusion_t *fusion, uint32_t value, uint32_t timestamp, uint8_t inputStatus, uint32_t *corrected);
+uint32_t Fusion_growthFactor(uint8_t kappa, uint16_t relativeHumidity);
+
+#endif
+/** @}*/
@@ -1,12 +1,206 @@
 /*******************| Inclusions |*************************************/
-#include "gp2y1050.h"
-#include <gp2y1050.h_cfg.h>
+#include "gp2y1050_hal.h"
+
+/**
+ * @brief Module for Sharp GP2Y1010AU optical dust sensor
+ * Measurement procedure:
+ * - The IR LED is pulsed for 0.32ms every 10ms, the analog output must be
+ *   sampled 0.28ms after switching on the LED.
+ * - LED pulse and ADC start are generated by a timer (e.g. Timer1 compare
+ *   output for the LED and compare event as ADC trigger), no software delay is
+ *   used. The samples are delivered by the ADC interrupt through
+ *   GP2Y1050_adcCallback, which ends the burst after the last one.
+ * - After a burst of samples the outliers are removed and the remaining
+ *   samples are averaged and converted to dust density in GP2Y1050_poll.
+ * The hardware is accessed through these macros only, by default mapped to
+ * the backend of gp2y1050_hal.h, gp2y1050_cfg.h may provide its own:
+ * - GP2Y1050_InitPulseTimer(): configure timer, ADC and DMA, LED off
+ * - GP2Y1050_StartPulseTimer(): start LED pulse train and ADC triggering
+ * - GP2Y1050_StopPulseTimer(): stop pulse train and switch LED off
+*/
 
 /*******************| Macros |*****************************************/
+/* ADC result at full scale */
+#define GP2Y1050_ADCMAXVALUE                    ((uint16_t)((1UL << GP2Y1050_ADCRESOLUTIONBITS) - 1))
 
 /*******************| Type definitions |*******************************/
 
+/*******************| Function prototypes |****************************/
+static void GP2Y1050_burstComplete(void);
+
 /*******************| Global variables |*******************************/
+static GP2Y1050State_t GP2Y1050State = GP2Y1050State_Uninit;
+
+/**
+ * Samples of the current burst, written by GP2Y1050_adcCallback
+ */
+static uint16_t GP2Y1050_samples[GP2Y1050_MAXSAMPLES];
+static volatile uint8_t GP2Y1050_sampleCounter;
+static uint8_t GP2Y1050_numberOfSamples;
+
+/**
+ * Dust density of last burst in ug/m^3
+ */
+static uint16_t GP2Y1050_dustDensity;
 
+/**
+ * Run time statistics, lostSampleCounter is written from the ADC interrupt
+ */
+static volatile GP2Y1050_Statistics_t GP2Y1050_statistics;
 
 /*******************| Function definition |****************************/
+void GP2Y1050_init(void)
+{
+  if (GP2Y1050State == GP2Y1050State_Sampling) GP2Y1050_statistics.abortedBurstCounter++;
+  GP2Y1050_InitPulseTimer();
+  GP2Y1050State = GP2Y1050State_Init;
+}
+
+/**
+ * Start a burst of LED pulses and samples. Never blocks, the result is
+ * available once GP2Y1050_poll returns GP2Y1050State_ReadDone. A burst can be
+ * started after init and after the previous burst was filtered, also if it was
+ * implausible.
+ * @param numberOfSamples number of pulses, at most GP2Y1050_MAXSAMPLES
+ * @return GP2Y1050State_Sampling if burst was started
+ */
+GP2Y1050State_t GP2Y1050_startBurst(uint8_t numberOfSamples)
+{
+  if (((GP2Y1050State == GP2Y1050State_Init) || (GP2Y1050State == GP2Y1050State_ReadDone) || (GP2Y1050State == GP2Y1050State_ReadErrorImplausible)) && (numberOfSamples > 0))
+  {
+    if (numberOfSamples > GP2Y1050_MAXSAMPLES) numberOfSamples = GP2Y1050_MAXSAMPLES;
+    GP2Y1050_numberOfSamples = numberOfSamples;
+    GP2Y1050_sampleCounter = 0;
+    GP2Y1050State = GP2Y1050State_Sampling;
+    GP2Y1050_statistics.burstCounter++;
+    GP2Y1050_StartPulseTimer();
+  }
+  return GP2Y1050State;
+}
+
+/**
+ * Must be called periodically from the main loop. Filters the samples once the
+ * burst is complete. A burst whose samples are all 0 (no signal although the
+ * LED was on) or all at full scale is implausible. Single samples at 0 or full
+ * scale are outliers removed by the filter.
+ * @return GP2Y1050State_ReadDone if a new dust density is available,
+ * GP2Y1050State_ReadErrorImplausible if the burst was discarded
+ */
+GP2Y1050State_t GP2Y1050_poll(void)
+{
+  if (GP2Y1050State == GP2Y1050State_SamplingDone)
+  {
+    GP2Y1050_dustDensity = GP2Y1050_calculateDustDensity(GP2Y1050_filterSamples(GP2Y1050_samples, GP2Y1050_numberOfSamples));
+    /* samples are sorted now */
+    GP2Y1050_statistics.lastSpread = GP2Y1050_samples[GP2Y1050_numberOfSamples - 1] - GP2Y1050_samples[0];
+    if (GP2Y1050_statistics.lastSpread > GP2Y1050_statistics.maxSpread) GP2Y1050_statistics.maxSpread = GP2Y1050_statistics.lastSpread;
+    if ((GP2Y1050_samples[GP2Y1050_numberOfSamples - 1] == 0) || (GP2Y1050_samples[0] >= GP2Y1050_ADCMAXVALUE))
+    {
+      GP2Y1050_statistics.implausibleCounter++;
+      GP2Y1050State = GP2Y1050State_ReadErrorImplausible;
+    }
+    else
+    {
+      GP2Y1050State = GP2Y1050State_ReadDone;
+    }
+  }
+  return GP2Y1050State;
+}
+
+/**
+ * ADC conversion complete, called from the ADC interrupt of the backend.
+ * Stores the sample and ends the burst after the last one.
+ * @param sample ADC result, right aligned
+ */
+void GP2Y1050_adcCallback(uint16_t sample)
+{
+  if (GP2Y1050State != GP2Y1050State_Sampling)
+  {
+    GP2Y1050_statistics.lostSampleCounter++;
+    return;
+  }
+  GP2Y1050_samples[GP2Y1050_sampleCounter] = sample;
+  if (++GP2Y1050_sampleCounter >= GP2Y1050_numberOfSamples) GP2Y1050_burstComplete();
+}
+
+/**
+ * End of burst, called by GP2Y1050_adcCallback after the last sample.
+ */
+static void GP2Y1050_burstComplete(void)
+{
+  if (GP2Y1050State != GP2Y1050State_Sampling) return;
+  GP2Y1050_StopPulseTimer();
+  GP2Y1050State = GP2Y1050State_SamplingDone;
+}
+
+/**
+ * Readout function for dust density of the last burst.
+ * @param density dust density in ug/m^3
+ * @return GP2Y1050_OK if a value is available, GP2Y1050_NOT_OK otherwise
+ */
+uint8_t GP2Y1050_readDustDensity(uint16_t *density)
+{
+  if (GP2Y1050State != GP2Y1050State_ReadDone) return GP2Y1050_NOT_OK;
+  *density = GP2Y1050_dustDensity;
+  return GP2Y1050_OK;
+}
+
+/**
+ * Get a consistent copy of the run time statistics. The copy is repeated if an
+ * ADC interrupt changed it meanwhile.
+ * @param statistics receives the copy
+ */
+void GP2Y1050_readStatistics(GP2Y1050_Statistics_t *statistics)
+{
+  do
+  {
+    *statistics = GP2Y1050_statistics;
+  } while (statistics->lostSampleCounter != GP2Y1050_statistics.lostSampleCounter);
+}
+
+/**
+ * Sort samples and average them without the GP2Y1050_TRIMSAMPLES lowest and
+ * highest ones. Insertion sort is used as bursts are short.
+ * @param samples samples, will be sorted
+ * @param numberOfSamples number of samples
+ * @return filtered ADC value
+ */
+uint16_t GP2Y1050_filterSamples(uint16_t *samples, uint8_t numberOfSamples)
+{
+  uint32_t sum = 0;
+  uint16_t sample;
+  uint8_t trim = GP2Y1050_TRIMSAMPLES;
+  uint8_t i;
+  uint8_t j;
+
+  if (numberOfSamples == 0) return 0;
+  for (i = 1; i < numberOfSamples; i++)
+  {
+    sample = samples[i];
+    for (j = i; (j > 0) && (samples[j - 1] > sample); j--)
+    {
+      samples[j] = samples[j - 1];
+    }
+    samples[j] = sample;
+  }
+  /* keep at least one sample */
+  if ((uint8_t)(2 * trim) >= numberOfSamples) trim = (numberOfSamples - 1) / 2;
+  for (i = trim; i < numberOfSamples - trim; i++)
+  {
+    sum += samples[i];
+  }
+  return (uint16_t)(sum / (numberOfSamples - 2 * trim));
+}
+
+/**
+ * Transform ADC value to dust density using the typical datasheet curve.
+ * @param sample ADC value
+ * @return dust density in ug/m^3, 0 if output is below no dust voltage
+ */
+uint16_t GP2Y1050_calculateDustDensity(uint16_t sample)
+{
+  uint16_t voltage = (uint16_t)(((uint32_t)sample * GP2Y1050_ADCFULLSCALEMV) >> GP2Y1050_ADCRESOLUTIONBITS);
+
+  if (voltage <= GP2Y1050_NODUSTVOLTAGEMV) return 0;
+  return (voltage - GP2Y1050_NODUSTVOLTAGEMV) / GP2Y1050_SENSITIVITYMVPERUG;
+}
\ No newline at end of file
@@ -4,16 +4,113 @@
 
 #ifndef GP2Y1050_H_
 #define GP2Y1050_H_
-   
+
 /*******************| Inclusions |*************************************/
 #include <PlatformTypes.h>
-   
+/* configuration decides on buffer sizes, thus included here */
+#include <gp2y1050_cfg.h>
+
 /*******************| Macros |*****************************************/
-   
+#if (!defined GP2Y1050_OK)
+#define GP2Y1050_OK        0
+#endif
+
+#if (!defined GP2Y1050_NOT_OK)
+#define GP2Y1050_NOT_OK    1
+#endif
+
+/**
+ * Maximum number of LED pulses (samples) per burst
+ */
+#if (!defined GP2Y1050_MAXSAMPLES)
+#define GP2Y1050_MAXSAMPLES                     16
+#endif
+
+/**
+ * Number of lowest and highest samples of a burst ignored for averaging. 0
+ * gives the plain average, (samples - 1) / 2 the median.
+ */
+#if (!defined GP2Y1050_TRIMSAMPLES)
+#define GP2Y1050_TRIMSAMPLES                    2
+#endif
+
+/**
+ * ADC conversion: full scale in mV at the sensor output (including a voltage
+ * divider in front of the ADC if any) and resolution. The CC2530 backend
+ * delivers 11 bit, the positive half of its 12 bit conversion.
+ */
+#if (!defined GP2Y1050_ADCFULLSCALEMV)
+#define GP2Y1050_ADCFULLSCALEMV                 3300
+#endif
+#if (!defined GP2Y1050_ADCRESOLUTIONBITS)
+#define GP2Y1050_ADCRESOLUTIONBITS              11
+#endif
+
+/**
+ * Output voltage without dust, datasheet gives 0.9V typical, 0-1.5V range.
+ * Should be calibrated in clean air.
+ */
+#if (!defined GP2Y1050_NODUSTVOLTAGEMV)
+#define GP2Y1050_NODUSTVOLTAGEMV                900
+#endif
+
+/**
+ * Sensitivity, datasheet gives 0.5V per 0.1mg/m^3 typical, i.e. 5mV per ug/m^3
+ */
+#if (!defined GP2Y1050_SENSITIVITYMVPERUG)
+#define GP2Y1050_SENSITIVITYMVPERUG             5
+#endif
+
+/* Configuration is checked here, sample counters are 8 bit and the voltage
+ * conversion is done in 32 bit */
+#if (GP2Y1050_MAXSAMPLES < 1) || (GP2Y1050_MAXSAMPLES > 0xff)
+#error "GP2Y1050_MAXSAMPLES must be 1..255"
+#endif
+#if (2 * GP2Y1050_TRIMSAMPLES >= GP2Y1050_MAXSAMPLES)
+#error "GP2Y1050_TRIMSAMPLES must leave at least one sample of a full burst"
+#endif
+#if (GP2Y1050_ADCRESOLUTIONBITS < 1) || (GP2Y1050_ADCRESOLUTIONBITS > 16) || ((GP2Y1050_ADCFULLSCALEMV << GP2Y1050_ADCRESOLUTIONBITS) > 0xffffffffUL)
+#error "GP2Y1050_ADCRESOLUTIONBITS must be 1..16 and full scale times resolution must fit into 32 bit"
+#endif
+#if (GP2Y1050_SENSITIVITYMVPERUG < 1) || (GP2Y1050_NODUSTVOLTAGEMV >= GP2Y1050_ADCFULLSCALEMV)
+#error "GP2Y1050_SENSITIVITYMVPERUG must be positive and GP2Y1050_NODUSTVOLTAGEMV below full scale"
+#endif
+
 /*******************| Type definitions |*******************************/
+typedef enum
+{
+   GP2Y1050State_Uninit,
+   GP2Y1050State_Init,
+   GP2Y1050State_Sampling,                      /*!< LED pulse train running, samples are collected */
+   GP2Y1050State_SamplingDone,                  /*!< all samples collected, not yet filtered */
+   GP2Y1050State_ReadDone,                      /*!< dust density of last burst is available */
+   GP2Y1050State_ReadErrorImplausible           /*!< all samples saturated or all without signal, sensor disconnected or not powered */
+} GP2Y1050State_t;
+
+/**
+ * Run time statistics of the driver, always enabled, see GP2Y1050_readStatistics
+ */
+typedef struct
+{
+  uint16_t burstCounter;                        /*!< bursts started */
+  uint16_t abortedBurstCounter;                 /*!< bursts stopped by GP2Y1050_init before completion */
+  uint16_t lostSampleCounter;                   /*!< ADC results arriving while no burst was running */
+  uint16_t implausibleCounter;                  /*!< bursts ending in GP2Y1050State_ReadErrorImplausible */
+  uint16_t lastSpread;                          /*!< difference between highest and lowest sample of the last burst */
+  uint16_t maxSpread;
+} GP2Y1050_Statistics_t;
 
 /*******************| Global variables |*******************************/
 
 /*******************| Function prototypes |****************************/
+void GP2Y1050_init(void);
+GP2Y1050State_t GP2Y1050_startBurst(uint8_t numberOfSamples);
+GP2Y1050State_t GP2Y1050_poll(void);
+void GP2Y1050_adcCallback(uint16_t sample);
+uint8_t GP2Y1050_readDustDensity(uint16_t *density);
+void GP2Y1050_readStatistics(GP2Y1050_Statistics_t *statistics);
+uint16_t GP2Y1050_filterSamples(uint16_t *samples, uint8_t numberOfSamples);
+uint16_t GP2Y1050_calculateDustDensity(uint16_t sample);
+
 #endif
 /** @}*/
\ No newline at end of file
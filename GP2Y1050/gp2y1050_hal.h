@@ -0,0 +1,60 @@
+/** @ingroup GP2Y1050
+ * @{
+ */
+#ifndef GP2Y1050_HAL_H_
+#define GP2Y1050_HAL_H_
+/**
+ * Hardware abstraction for the GP2Y1050 driver. A backend generates the LED
+ * pulse train and triggers one ADC conversion GP2Y1050_SAMPLEDELAY after each
+ * LED pulse started, every result is passed to GP2Y1050_adcCallback which
+ * counts the samples and ends the burst:
+ * - void GP2Y1050_halInit(void): configure timer channels, ADC and DMA, LED off
+ * - void GP2Y1050_halStart(void): start pulse train and ADC triggering
+ * - void GP2Y1050_halStop(void): stop pulse train and switch LED off
+ * The cfg macros GP2Y1050_InitPulseTimer, GP2Y1050_StartPulseTimer and
+ * GP2Y1050_StopPulseTimer map to these functions unless gp2y1050_cfg.h
+ * provides its own. The CC2530 backend is used unless GP2Y1050_HAL_HOST is
+ * defined, the host backend runs a simulated ADC, see gp2y1050_hal_host.h.
+*/
+
+/*******************| Inclusions |*************************************/
+#include "gp2y1050.h"
+#ifdef GP2Y1050_HAL_HOST
+#include "gp2y1050_hal_host.h"
+#else
+#include "gp2y1050_hal_cc2530.h"
+#endif
+
+/*******************| Macros |*****************************************/
+/**
+ * LED pulse width and time from LED on to ADC start in timer ticks (us),
+ * datasheet: 0.32ms and 0.28ms
+ */
+#if (!defined GP2Y1050_LEDPULSETIME)
+#define GP2Y1050_LEDPULSETIME                   320
+#endif
+#if (!defined GP2Y1050_SAMPLEDELAY)
+#define GP2Y1050_SAMPLEDELAY                    280
+#endif
+
+#if (GP2Y1050_SAMPLEDELAY >= GP2Y1050_LEDPULSETIME)
+#error "GP2Y1050_SAMPLEDELAY must end within the LED pulse"
+#endif
+
+#if (!defined GP2Y1050_InitPulseTimer)
+#define GP2Y1050_InitPulseTimer()                                GP2Y1050_halInit()
+#endif
+#if (!defined GP2Y1050_StartPulseTimer)
+#define GP2Y1050_StartPulseTimer()                               GP2Y1050_halStart()
+#endif
+#if (!defined GP2Y1050_StopPulseTimer)
+#define GP2Y1050_StopPulseTimer()                                GP2Y1050_halStop()
+#endif
+
+/*******************| Function prototypes |****************************/
+void GP2Y1050_halInit(void);
+void GP2Y1050_halStart(void);
+void GP2Y1050_halStop(void);
+
+#endif
+/** @}*/
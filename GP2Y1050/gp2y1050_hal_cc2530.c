@@ -0,0 +1,167 @@
+/*******************| Inclusions |*************************************/
+#include "gp2y1050_hal.h"
+
+#ifndef GP2Y1050_HAL_HOST
+/**
+ * @brief CC2530 backend for GP2Y1050 module
+ * Timer1 runs free with 1MHz (shared with PPD42NS), i.e. one LED pulse per
+ * timer period of 65.5ms. The datasheet pulse cycle is 10ms, a longer cycle
+ * only lowers the LED duty cycle, the output is still sampled 0.28ms after
+ * the LED was switched on. A burst of 16 samples takes about 1s.
+ * - LED: channel 3 in compare mode "clear output on compare-up, set on 0"
+ *   pulls the LED pin low for the last GP2Y1050_LEDPULSETIME ticks of each
+ *   period, no interrupt.
+ * - ADC trigger: the ADC can only be started by Timer1 channel 0 directly,
+ *   which is a PPD42NS capture channel. Instead the compare event of channel 2
+ *   GP2Y1050_SAMPLEDELAY after the LED went on triggers DMA channel 0, which
+ *   writes the conversion settings to ADCCON3 and thus starts a single
+ *   conversion. DMA runs in repeated single mode, i.e. it re-arms itself.
+ * - Result: single conversions have no DMA trigger, the ADC interrupt reads
+ *   the result and passes it to GP2Y1050_adcCallback, which ends the burst.
+ * The reference is AVDD5 (GP2Y1050_ADCFULLSCALEMV) with 512 decimation, i.e.
+ * 12 bit two's complement of which single-ended inputs use 11 bit, see
+ * GP2Y1050_ADCRESOLUTIONBITS.
+*/
+
+/*******************| Macros |*****************************************/
+/* timer value switching the LED on and starting the conversion */
+#define GP2Y1050_HALLEDON                       ((uint16_t)(0x10000UL - GP2Y1050_LEDPULSETIME))
+#define GP2Y1050_HALADCSTART                    ((uint16_t)(GP2Y1050_HALLEDON + GP2Y1050_SAMPLEDELAY))
+
+/* pulse trains are not armed closer than this to the LED pulse, covers the
+ * arming itself */
+#define GP2Y1050_HALARMMARGIN                   50
+
+/* T1CCTLn: compare mode, CMP[5:3] 000 set on compare, 100 clear on
+ * compare-up and set on 0, 111 initialize output pin */
+#define GP2Y1050_HALT1CCTL_COMPARE              0x04
+#define GP2Y1050_HALT1CCTL_CMP_SET              0x00
+#define GP2Y1050_HALT1CCTL_CMP_CLEARUPSET0      0x20
+#define GP2Y1050_HALT1CCTL_CMP_INIT             0x38
+
+/* ADCCON3: reference AVDD5, 512 decimation, input channel */
+#define GP2Y1050_HALADCCON3                     (0x80 | 0x30 | GP2Y1050_ADCCHANNEL)
+
+/* XDATA address of ADCCON3, SFRs are mapped to 0x7080..0x70FF for DMA */
+#define GP2Y1050_HALADCCON3XADDR                0x70B6
+
+/* DMA: byte, repeated single mode, trigger T1_CH2; no increment, no
+ * interrupt, high priority */
+#define GP2Y1050_HALDMATMODETRIG                (0x40 | 4)
+#define GP2Y1050_HALDMAPRIORITY                 0x02
+#define GP2Y1050_HALDMACHANNEL0                 0x01
+#define GP2Y1050_HALDMAABORT                    0x80
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static uint16_t GP2Y1050_halReadTimer(void);
+
+/*******************| Global variables |*******************************/
+/**
+ * Value written to ADCCON3 by DMA and the DMA descriptor, both must be
+ * accessible by DMA, i.e. in XDATA
+ */
+static __xdata uint8_t GP2Y1050_halAdcStart = GP2Y1050_HALADCCON3;
+static __xdata GP2Y1050_halDmaConfig_t GP2Y1050_halDmaConfig;
+
+/*******************| Function definition |****************************/
+/**
+ * Configure compare values, ADC input and DMA descriptor, LED off. Timer1 is
+ * started if PPD42NS did not start it yet.
+ */
+void GP2Y1050_halInit(void)
+{
+  GP2Y1050_halStop();
+  PERCFG |= PERCFG_T1CFG_ALT1;
+  /* LED pin is a GPIO driving high while no burst runs */
+  P0 |= GP2Y1050_HALLEDPINMASK;
+  P0DIR |= GP2Y1050_HALLEDPINMASK;
+  APCFG |= (uint8_t)(1 << GP2Y1050_ADCCHANNEL);
+  /* compare values take effect immediately as long as the channels are not
+   * in compare mode, thus they are set once here */
+  T1CC3L = (uint8_t)GP2Y1050_HALLEDON;
+  T1CC3H = (uint8_t)(GP2Y1050_HALLEDON >> 8);
+  T1CC2L = (uint8_t)GP2Y1050_HALADCSTART;
+  T1CC2H = (uint8_t)(GP2Y1050_HALADCSTART >> 8);
+  GP2Y1050_halDmaConfig.srcAddrH = (uint8_t)((uint16_t)&GP2Y1050_halAdcStart >> 8);
+  GP2Y1050_halDmaConfig.srcAddrL = (uint8_t)(uint16_t)&GP2Y1050_halAdcStart;
+  GP2Y1050_halDmaConfig.destAddrH = (uint8_t)(GP2Y1050_HALADCCON3XADDR >> 8);
+  GP2Y1050_halDmaConfig.destAddrL = (uint8_t)GP2Y1050_HALADCCON3XADDR;
+  GP2Y1050_halDmaConfig.vlenLenH = 0;
+  GP2Y1050_halDmaConfig.lenL = 1;
+  GP2Y1050_halDmaConfig.wordSizeTModeTrig = GP2Y1050_HALDMATMODETRIG;
+  GP2Y1050_halDmaConfig.incIrqM8Priority = GP2Y1050_HALDMAPRIORITY;
+  DMA0CFGH = (uint8_t)((uint16_t)&GP2Y1050_halDmaConfig >> 8);
+  DMA0CFGL = (uint8_t)(uint16_t)&GP2Y1050_halDmaConfig;
+  ADCIF = 0;
+  ADCIE = 1;
+  if ((T1CTL & 0x03) == 0)
+  {
+    Timer1_startSynchronous(T1CTL_DIV_DIV32 | T1CTL_MODE_FREERUNNING, 0x0000);
+  }
+}
+
+/**
+ * Start the pulse train. Armed with interrupts masked and outside the LED
+ * pulse, otherwise the first conversion could see a short or no LED pulse.
+ * Called from the main loop, waits at most GP2Y1050_LEDPULSETIME plus the
+ * margin.
+ */
+void GP2Y1050_halStart(void)
+{
+  uint8_t interruptsEnabled;
+
+  for (;;)
+  {
+    interruptsEnabled = EA;
+    EA = 0;
+    if (GP2Y1050_halReadTimer() < GP2Y1050_HALLEDON - GP2Y1050_HALARMMARGIN) break;
+    EA = interruptsEnabled;
+  }
+  DMAARM = GP2Y1050_HALDMACHANNEL0;
+  T1CCTL2 = GP2Y1050_HALT1CCTL_COMPARE | GP2Y1050_HALT1CCTL_CMP_SET;
+  /* output starts at its idle level (high, LED off) before the pin is
+   * handed over to the timer */
+  T1CCTL3 = GP2Y1050_HALT1CCTL_COMPARE | GP2Y1050_HALT1CCTL_CMP_INIT;
+  T1CCTL3 = GP2Y1050_HALT1CCTL_COMPARE | GP2Y1050_HALT1CCTL_CMP_CLEARUPSET0;
+  P0SEL |= GP2Y1050_HALLEDPINMASK;
+  EA = interruptsEnabled;
+}
+
+/**
+ * Stop the pulse train, LED pin back to GPIO (high, LED off). Also called
+ * from the ADC interrupt at the end of a burst.
+ */
+void GP2Y1050_halStop(void)
+{
+  P0SEL &= (uint8_t)~GP2Y1050_HALLEDPINMASK;
+  T1CCTL3 = 0;
+  T1CCTL2 = 0;
+  DMAARM = GP2Y1050_HALDMAABORT | GP2Y1050_HALDMACHANNEL0;
+}
+
+/**
+ * ADC conversion complete. The result is left aligned two's complement, with
+ * 512 decimation the 12 upper bits are valid. Negative results of a single
+ * ended input around 0V are clamped.
+ */
+GP2Y1050_ADCISR void GP2Y1050_halAdcISR(void)
+{
+  uint8_t low = ADCL;
+  sint16_t result = (sint16_t)(((uint16_t)ADCH << 8) | low);
+
+  ADCIF = 0;
+  GP2Y1050_adcCallback((result < 0) ? 0 : (uint16_t)result >> 4);
+}
+
+/**
+ * Read Timer1 counter. Reading T1CNTL latches T1CNTH, thus low byte first.
+ */
+static uint16_t GP2Y1050_halReadTimer(void)
+{
+  uint8_t low = T1CNTL;
+
+  return ((uint16_t)T1CNTH << 8) | low;
+}
+#endif
@@ -0,0 +1,53 @@
+/** @ingroup GP2Y1050
+ * @{
+ */
+#ifndef GP2Y1050_HAL_CC2530_H_
+#define GP2Y1050_HAL_CC2530_H_
+
+/*******************| Inclusions |*************************************/
+#include <ioCC2530.h>
+#include <CC253x.h>
+#include <Timer1.h>
+
+/*******************| Macros |*****************************************/
+/**
+ * ADC input of the sensor output, AIN0..AIN7 are P0.0..P0.7. P0.2..P0.6 are
+ * Timer1 channels (PPD42NS, LED), thus AIN7 by default.
+ */
+#if (!defined GP2Y1050_ADCCHANNEL)
+#define GP2Y1050_ADCCHANNEL                     7
+#endif
+
+/**
+ * Timer1 channel 3 (P0.5, alternative 1 location) drives the LED pin, low
+ * switches the LED on. Channel 2 only generates the compare event which lets
+ * DMA start the conversion, its pin P0.4 stays a GPIO. Both channels are
+ * capture channels of a second PPD42NS sensor, i.e. only one PPD42NS sensor
+ * (PPD42NS_NUMBEROFCHANNELS <= 2) can be used together with the GP2Y1050.
+ */
+#define GP2Y1050_HALLEDPINMASK                  0x20
+
+/* the ISR of the ADC conversion complete interrupt */
+#define GP2Y1050_ADCISR                         _Pragma("vector = ADC_VECTOR") __near_func __interrupt
+
+#if (GP2Y1050_ADCCHANNEL > 7)
+#error "GP2Y1050_ADCCHANNEL must be one of AIN0..AIN7"
+#endif
+
+/*******************| Type definitions |*******************************/
+/**
+ * DMA configuration data structure, see CC2530 user's guide 8.2.2
+ */
+typedef struct {
+  uint8_t srcAddrH;
+  uint8_t srcAddrL;
+  uint8_t destAddrH;
+  uint8_t destAddrL;
+  uint8_t vlenLenH;                             /**< VLEN[7:5], LEN[12:8] */
+  uint8_t lenL;
+  uint8_t wordSizeTModeTrig;                    /**< WORDSIZE[7], TMODE[6:5], TRIG[4:0] */
+  uint8_t incIrqM8Priority;                     /**< SRCINC[7:6], DESTINC[5:4], IRQMASK[3], M8[2], PRIORITY[1:0] */
+} GP2Y1050_halDmaConfig_t;
+
+#endif
+/** @}*/
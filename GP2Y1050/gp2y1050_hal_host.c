@@ -0,0 +1,151 @@
+/*******************| Inclusions |*************************************/
+#include "gp2y1050_hal.h"
+
+#ifdef GP2Y1050_HAL_HOST
+/*******************| Macros |*****************************************/
+#define GP2Y1050_HOSTADCMAXVALUE                ((sint32_t)((1UL << GP2Y1050_ADCRESOLUTIONBITS) - 1))
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static uint16_t GP2Y1050_hostConvert(void);
+static uint16_t GP2Y1050_hostRandom(void);
+
+/*******************| Global variables |*******************************/
+uint32_t GP2Y1050_hostTime;
+uint16_t GP2Y1050_hostPulseCounter;
+
+/**
+ * Sensor output: voltage and noise in mV, or a sequence of ADC results if
+ * numberOfSamples is not 0
+ */
+static uint16_t GP2Y1050_hostVoltage;
+static uint16_t GP2Y1050_hostNoise;
+static uint16_t GP2Y1050_hostSamples[GP2Y1050_HOSTMAXSAMPLES];
+static uint8_t GP2Y1050_hostNumberOfSamples;
+static uint8_t GP2Y1050_hostSampleIndex;
+
+/**
+ * Pulse train running and time of the next LED pulse
+ */
+static uint8_t GP2Y1050_hostPulsing;
+static uint32_t GP2Y1050_hostNextPulse;
+
+/**
+ * State of the noise generator, fixed seed keeps runs reproducible
+ */
+static uint32_t GP2Y1050_hostRandomState;
+
+/*******************| Function definition |****************************/
+/**
+ * Reset simulated time, the sensor output is 0V without noise
+ */
+void GP2Y1050_hostInit(void)
+{
+  GP2Y1050_hostTime = 0;
+  GP2Y1050_hostPulseCounter = 0;
+  GP2Y1050_hostRandomState = 1;
+  GP2Y1050_hostPulsing = 0;
+  GP2Y1050_hostSetVoltage(0, 0);
+}
+
+/**
+ * Set the sensor output 0.28ms into the LED pulse.
+ * @param voltage output voltage in mV
+ * @param noise maximum deviation in mV, uniformly distributed
+ */
+void GP2Y1050_hostSetVoltage(uint16_t voltage, uint16_t noise)
+{
+  GP2Y1050_hostVoltage = voltage;
+  GP2Y1050_hostNoise = noise;
+  GP2Y1050_hostNumberOfSamples = 0;
+}
+
+/**
+ * Set the ADC results of the following conversions, the sequence starts over
+ * after the last one.
+ * @param samples ADC results, right aligned
+ * @param numberOfSamples number of results, at most GP2Y1050_HOSTMAXSAMPLES
+ */
+void GP2Y1050_hostSetSamples(const uint16_t *samples, uint8_t numberOfSamples)
+{
+  uint8_t sample;
+
+  if (numberOfSamples > GP2Y1050_HOSTMAXSAMPLES) numberOfSamples = GP2Y1050_HOSTMAXSAMPLES;
+  for (sample = 0; sample < numberOfSamples; sample++)
+  {
+    GP2Y1050_hostSamples[sample] = samples[sample];
+  }
+  GP2Y1050_hostNumberOfSamples = numberOfSamples;
+  GP2Y1050_hostSampleIndex = 0;
+}
+
+/**
+ * Let simulated time advance. While a pulse train runs, each conversion due
+ * up to the given time is passed to GP2Y1050_adcCallback like the ADC
+ * interrupt of the target would.
+ * @param time simulated time in timer ticks (us)
+ */
+void GP2Y1050_hostRunUntil(uint32_t time)
+{
+  while (GP2Y1050_hostPulsing && (GP2Y1050_hostNextPulse + GP2Y1050_SAMPLEDELAY <= time))
+  {
+    GP2Y1050_hostTime = GP2Y1050_hostNextPulse + GP2Y1050_SAMPLEDELAY;
+    GP2Y1050_hostNextPulse += GP2Y1050_HOSTPULSEPERIOD;
+    GP2Y1050_hostPulseCounter++;
+    GP2Y1050_adcCallback(GP2Y1050_hostConvert());
+  }
+  if (time > GP2Y1050_hostTime) GP2Y1050_hostTime = time;
+}
+
+/**
+ * Start the pulse train, the first LED pulse is the next one of the timer
+ */
+void GP2Y1050_halStart(void)
+{
+  GP2Y1050_hostNextPulse = (GP2Y1050_hostTime | (GP2Y1050_HOSTPULSEPERIOD - 1)) + 1 - GP2Y1050_LEDPULSETIME;
+  if (GP2Y1050_hostNextPulse < GP2Y1050_hostTime) GP2Y1050_hostNextPulse += GP2Y1050_HOSTPULSEPERIOD;
+  GP2Y1050_hostPulsing = 1;
+}
+
+void GP2Y1050_halStop(void)
+{
+  GP2Y1050_hostPulsing = 0;
+}
+
+void GP2Y1050_halInit(void)
+{
+  GP2Y1050_halStop();
+}
+
+/**
+ * One conversion of the simulated ADC
+ * @return ADC result, right aligned
+ */
+static uint16_t GP2Y1050_hostConvert(void)
+{
+  sint32_t voltage = GP2Y1050_hostVoltage;
+  sint32_t sample;
+
+  if (GP2Y1050_hostNumberOfSamples)
+  {
+    sample = GP2Y1050_hostSamples[GP2Y1050_hostSampleIndex];
+    if (++GP2Y1050_hostSampleIndex >= GP2Y1050_hostNumberOfSamples) GP2Y1050_hostSampleIndex = 0;
+    return (uint16_t)sample;
+  }
+  if (GP2Y1050_hostNoise) voltage += (sint32_t)(GP2Y1050_hostRandom() % (2UL * GP2Y1050_hostNoise + 1)) - GP2Y1050_hostNoise;
+  if (voltage < 0) voltage = 0;
+  sample = (sint32_t)(((voltage << GP2Y1050_ADCRESOLUTIONBITS) + GP2Y1050_ADCFULLSCALEMV / 2) / GP2Y1050_ADCFULLSCALEMV);
+  if (sample > GP2Y1050_HOSTADCMAXVALUE) sample = GP2Y1050_HOSTADCMAXVALUE;
+  return (uint16_t)sample;
+}
+
+/**
+ * Linear congruential generator (Numerical Recipes constants)
+ */
+static uint16_t GP2Y1050_hostRandom(void)
+{
+  GP2Y1050_hostRandomState = GP2Y1050_hostRandomState * 1664525UL + 1013904223UL;
+  return (uint16_t)(GP2Y1050_hostRandomState >> 16);
+}
+#endif
@@ -0,0 +1,33 @@
+/** @ingroup GP2Y1050
+ * @{
+ */
+#ifndef GP2Y1050_HAL_HOST_H_
+#define GP2Y1050_HAL_HOST_H_
+/**
+ * Host backend for GP2Y1050 module with a simulated ADC. Like the CC2530
+ * backend there is one LED pulse per GP2Y1050_HOSTPULSEPERIOD while a burst
+ * runs, the conversion result arrives GP2Y1050_SAMPLEDELAY after the pulse
+ * started through GP2Y1050_adcCallback. Time only advances through
+ * GP2Y1050_hostRunUntil. The sensor output is either a voltage with uniform
+ * noise or a fixed sequence of ADC results, repeated as needed.
+*/
+
+/*******************| Macros |*****************************************/
+/* timer ticks (us) between LED pulses, one Timer1 period on the CC2530 */
+#define GP2Y1050_HOSTPULSEPERIOD                0x10000UL
+
+/* longest sequence of ADC results for GP2Y1050_hostSetSamples */
+#define GP2Y1050_HOSTMAXSAMPLES                 64
+
+/*******************| Global variables |*******************************/
+extern uint32_t GP2Y1050_hostTime;              /**< simulated time in timer ticks (us) */
+extern uint16_t GP2Y1050_hostPulseCounter;      /**< LED pulses since GP2Y1050_hostInit */
+
+/*******************| Function prototypes |****************************/
+void GP2Y1050_hostInit(void);
+void GP2Y1050_hostSetVoltage(uint16_t voltage, uint16_t noise);
+void GP2Y1050_hostSetSamples(const uint16_t *samples, uint8_t numberOfSamples);
+void GP2Y1050_hostRunUntil(uint32_t time);
+
+#endif
+/** @}*/
@@ -1,81 +1,175 @@
 /*******************| Inclusions |*************************************/
 #include "ppd42ns.h"
-#include "Config.h"
-#include <ioCC2530.h>
-#include <stdbool.h>
-#include <CC253x.h>
-#include <Timer1.h>
+#include "ppd42ns_hal.h"
+#include <timebase.h>
 
 /**
  * @brief Module for Shinyei PPD42NS sensor
  * Measurement procedure:
- * - Timer one will run until a given number of overflows is reached
+ * - Timer one is running freely, a given number of overflows form one bucket
  * - During this time positive and negative input capture interrupts are
- *   used to sum up low occupancy time
+ *   used to sum up low occupancy time of the bucket
+ * - At the end of each bucket the ratio over the last n buckets (the window)
+ *   is published, i.e. the window slides by one bucket
  * Connecting the sensor: P1 output corresponds to 1um particles and P2 output 
  * corresponds to 2,5um particles. P1 shoud be connected to P0.2 (input capture
- * unit 0, P2 should be conncected to P0.3(input capture unit 1).
+ * unit 0, P2 should be conncected to P0.3(input capture unit 1). Further
+ * sensors use the next two capture units, see PPD42NS_NUMBEROFCHANNELS.
 */
 
 /*******************| Macros |*****************************************/
+#define PPD42NS_SATURATEDINCREMENT(counter)     do { if ((counter) != 0xff) (counter)++; } while (0)
+
+/* Number of entries of the concentration curve, one per 1% low occupancy ratio */
+#define PPD42NS_CONCENTRATIONCURVEPOINTS        21
 
 /*******************| Type definitions |*******************************/
 
+/*******************| Function prototypes |****************************/
+static void PPD42NS_closeBucket(void);
+static void PPD42NS_lowPulseEnd(PPD42DN_singleReadout_t *readout, uint32_t lowPulse);
+static uint16_t PPD42NS_readTimer(void);
+static uint8_t PPD42NS_overflowPending(void);
+
 /*******************| Global variables |*******************************/
-/** @todo add more sensors here */
-static PPD42DN_sensorValues_t PPD42NS_sensor0;
-#ifdef PPD42NS_SENSOR1CONNECTED
-static PPD42DN_sensorValues_t PPD42NS_sensor1;
-#endif
+/**
+ * Concentration curve of the datasheet in particles/0.01cf * 2 for low
+ * occupancy ratio 0%, 1%, ... 20%. Values are taken from the polynomial fit
+ * 1.1*r^3 - 3.8*r^2 + 520*r + 0.62 (r in percent). Linear interpolation
+ * between the points stays within 1% of the polynomial for ratios above
+ * 0.5% and within 3% above 0.1%.
+ */
+static const uint16_t PPD42NS_concentrationCurve[PPD42NS_CONCENTRATIONCURVEPOINTS] = {
+  1, 1036, 2068, 3112, 4180, 5286, 6443, 7663, 8961, 10349, 11841,
+  13450, 15188, 17070, 19108, 21316, 23707, 26293, 29089, 32107, 35361
+};
+
+/**
+ * Measurement values per capture channel. Channel
+ * sensor * PPD42NS_CHANNELSPERSENSOR + PPD42NS_CHANNEL_Px holds Px of sensor.
+ */
+static PPD42DN_singleReadout_t PPD42NS_readout[PPD42NS_NUMBEROFCHANNELS];
+
+/**
+ * Timer1 extended to 32 bit, capture values are extended with it. Pulse
+ * lengths are differences, thus wrapping is harmless.
+ */
+static Timebase_t PPD42NS_timebase;
+static const Timebase_Counter_t PPD42NS_timebaseCounter = {
+  PPD42NS_readTimer,
+  PPD42NS_overflowPending
+};
+
+/**
+ * Configuration in use, see PPD42NS_init
+ */
+static PPD42NS_Config_t PPD42NS_config;
 
 /**
- * Number of timer1 overflows during this measurement period
+ * Low occupancy time per bucket and channel for the last
+ * PPD42NS_config.numberOfBuckets buckets and its sum per channel
  */
-static uint32_t PPD42NS_counterValueTotal = 0;
+static uint32_t PPD42NS_bucketLowPulseOccupancy[PPD42NS_MAXNUMBEROFBUCKETS][PPD42NS_NUMBEROFCHANNELS];
+static uint32_t PPD42NS_windowLowPulseOccupancy[PPD42NS_NUMBEROFCHANNELS];
 
-static bool PPD42NS_nextSensorValueAvailable = false;
+/**
+ * Timer1 overflows in current bucket, ring index of current bucket and number
+ * of buckets filled since init
+ */
+static uint8_t PPD42NS_bucketOverflows = 0;
+static uint8_t PPD42NS_bucketIndex = 0;
+static uint8_t PPD42NS_filledBuckets = 0;
+
+/**
+ * Results of the last completed measurement periods. The ISR always writes the
+ * buffer not selected by PPD42NS_snapshotSequence and increments the sequence
+ * afterwards, thus readers never see a half written snapshot and no interrupt
+ * must be masked. Single byte sequence can be read atomic by the 8051. The
+ * buffers are volatile and PPD42NS_HalMemoryBarrier orders them against the
+ * sequence, otherwise the compiler (or a host CPU running the ISR in another
+ * thread) could move the copy across the sequence checks.
+ */
+static volatile PPD42NS_Snapshot_t PPD42NS_snapshot[2];
+static volatile uint8_t PPD42NS_snapshotSequence = 0;
+
+/**
+ * Sequence of the last snapshot returned by PPD42NS_waitForNextSenorValue
+ */
+static uint8_t PPD42NS_lastSnapshotSequence = 0;
+
+/**
+ * Run time statistics, ISR fields are only written by the ISR, the others only
+ * by the main loop
+ */
+static volatile PPD42NS_Statistics_t PPD42NS_statistics;
+
+/**
+ * Energy accounting of PPD42NS_waitForNextSenorValue: time of its last return
+ * and time slept since then
+ */
+static uint32_t PPD42NS_lastWaitTime;
+static uint32_t PPD42NS_sleepTime;
 
 /*******************| Function definition |****************************/
-void PPD42NS_init()
+/**
+ * Initialize Timer1 input capture for all configured channels and start
+ * measurement.
+ * @param config length of bucket and window, may be NULL to use
+ * PPD42NS_DEFAULTBUCKETLENGTH and PPD42NS_DEFAULTNUMBEROFBUCKETS
+ */
+void PPD42NS_init(const PPD42NS_Config_t *config)
 {
-  /* Initialize values for measurement */
-  PPD42NS_sensor0.P1.counterValueLowPulseOccupancy = 0;
-  PPD42NS_sensor0.P2.counterValueLowPulseOccupancy = 0;
-  
-  /* Two Timer1 input capture units will be used per Shinyei PPD43NS sensor 
-   * Channel0 -> P0.2, Channel1 -> P0.3, Channel2 -> P0.4, Channel3 -> P0.5, Channel4 -> P0.6
-   * Each Shinyei senor is using two channel.
-   */
-  PERCFG |= PERCFG_T1CFG_ALT1;
-  
-  /* No need to configure PIN direction because "When a channel is configured as an input 
-   * capture channel, the I/O pin associated with that channel is configured as an input."
-   * However, "Before an I/O pin can be used by the timer, the required I/O pin must be 
-   * configured as a Timer 1 peripheral pin."
-   */
-  P0SEL |= P0SEL_SELP0_2_PERIPHERALFUNCTION | P0SEL_SELP0_3_PERIPHERALFUNCTION | P0SEL_SELP0_4_PERIPHERALFUNCTION | P0SEL_SELP0_5_PERIPHERALFUNCTION;
-  
-  /* Set priority of peripherals to 
-   * 1st priority: Timer 1 channels 0-1
-   * 2nd priority: USART 1
-   * 3rd priority: USART 0
-   * 4th priority: Timer 1 channels 2-3 */
-  P2DIR = P2DIR_PRIP0_TIMER1CH01USART1USART0TIMER1CH23;
-  
-  /* Enable capture for channel 0 and 1 for sensor 1 including interrupt */
-  Timer1_captureCompareChannel0(T1CCTL0_IM | T1CCTL0_MODE_CAPTUREMODE | T1CCTL0_CAP_CAPTUREONALL);
-  Timer1_captureCompareChannel1(T1CCTL1_IM | T1CCTL1_MODE_CAPTUREMODE | T1CCTL1_CAP_CAPTUREONALL);
-#ifdef PPD42NS_SENSOR1CONNECTED
-  Timer1_captureCompareChannel2(T1CCTL2_IM | T1CCTL2_MODE_CAPTUREMODE | T1CCTL2_CAP_CAPTUREONALL);
-  Timer1_captureCompareChannel3(T1CCTL3_IM | T1CCTL3_MODE_CAPTUREMODE | T1CCTL3_CAP_CAPTUREONALL);
-#endif
-  
-  /* Enable timer 1 overflow interrupt */
-  enableInterrupt(TIMIF, TIMIF_OVFIM);
-  enableInterrupt(IEN1, IEN1_T1IE);
-  
-  /* Start timer1 with 1MHz (Divide by 32) and start timer 1 in free running mode */
-  Timer1_startSynchronous(T1CTL_DIV_DIV32 | T1CTL_MODE_FREERUNNING, 0x0000);  
+  uint8_t channel;
+  uint8_t bucket;
+  uint8_t bin;
+
+  PPD42NS_config.bucketLength = PPD42NS_DEFAULTBUCKETLENGTH;
+  PPD42NS_config.numberOfBuckets = PPD42NS_DEFAULTNUMBEROFBUCKETS;
+  PPD42NS_config.windowCallback = NULL;
+  if (config != NULL)
+  {
+    if (config->bucketLength > 0) PPD42NS_config.bucketLength = config->bucketLength;
+    if ((config->numberOfBuckets > 0) && (config->numberOfBuckets <= PPD42NS_MAXNUMBEROFBUCKETS)) PPD42NS_config.numberOfBuckets = config->numberOfBuckets;
+    PPD42NS_config.windowCallback = config->windowCallback;
+  }
+  PPD42NS_bucketOverflows = 0;
+  PPD42NS_bucketIndex = 0;
+  PPD42NS_filledBuckets = 0;
+  Timebase_init(&PPD42NS_timebase);
+  PPD42NS_statistics.isrCounter = 0;
+  PPD42NS_statistics.isrMaxTime = 0;
+  PPD42NS_statistics.isrAverageTime = 0;
+  PPD42NS_statistics.windowOverruns = 0;
+  PPD42NS_statistics.snapshotRetries = 0;
+  PPD42NS_statistics.lastSleepTime = 0;
+  PPD42NS_statistics.lastActiveTime = 0;
+  PPD42NS_sleepTime = 0;
+  /* windows published before init are no overruns */
+  PPD42NS_lastSnapshotSequence = PPD42NS_snapshotSequence;
+
+  for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+  {
+    /* Initialize values for measurement, a low pulse running right now can not be measured */
+    PPD42NS_readout[channel].counterValueLowPulseOccupancy = 0;
+    PPD42NS_readout[channel].lowPulseActive = 0;
+    PPD42NS_readout[channel].bucketsSinceError = PPD42NS_MAXNUMBEROFBUCKETS;
+    PPD42NS_readout[channel].bucketsSincePulse = 0;
+    PPD42NS_readout[channel].pulseStatistics.rejectedPulses = 0;
+    PPD42NS_readout[channel].pulseStatistics.edgeErrors = 0;
+    for (bin = 0; bin < PPD42NS_HISTOGRAMBINS; bin++)
+    {
+      PPD42NS_readout[channel].pulseStatistics.histogram[bin] = 0;
+    }
+    PPD42NS_windowLowPulseOccupancy[channel] = 0;
+    for (bucket = 0; bucket < PPD42NS_MAXNUMBEROFBUCKETS; bucket++)
+    {
+      PPD42NS_bucketLowPulseOccupancy[bucket][channel] = 0;
+    }
+  }
+
+  /* Configure input capture on both edges and start timer with 1MHz */
+  PPD42NS_halInit(PPD42NS_NUMBEROFCHANNELS);
+  PPD42NS_lastWaitTime = PPD42NS_readTime();
 }
 
 /**
@@ -87,184 +181,352 @@ void PPD42NS_init()
  * - Output compare event
  * This functions servers two purposes
  * 1. In case of input capture interrupt the function will sum-up the low occupance time
- * 2. In case of overflow interrupt the function will add and if a given
- * number is reached will calculate the ratio between low occupancy and total time.
+ * 2. In case of overflow interrupt the function will add and if the end of a
+ * bucket is reached will calculate the ratio between low occupancy and total
+ * time of the window.
 */
-#pragma vector = T1_VECTOR
-__near_func __interrupt void PPD42NS_inputCaptureISR(void)
+PPD42NS_ISR void PPD42NS_inputCaptureISR(void)
 {
   uint32_t currentTimerValue;
-  Timer1_t counterValue;
+  uint32_t isrEntryTime;
+  PPD42DN_singleReadout_t *readout;
+  uint8_t channelFlags;
+  uint8_t channel;
+  uint8_t overflowPending;
+  uint16_t isrTime;
   
-  /* Check T1STAT for interrupt source
-  The status register, T1STAT, contains the source interrupt flags for the terminal-count value event and the
-  five channel compare/capture events. A source interrupt flag is set when the corresponding event occurs,
-  regardless of interrupt mask bits. */
-  /* Channel0 -> P0.2 */
-  if (checkInterruptFlag(T1STAT, T1STAT_CH0IF) )
+  /* Check for interrupt source, channel flags are bit 0..4, only channels with
+   * a pending capture event are visited. Captures are extended relative to
+   * the timer read after the channel flags, i.e. after the captures: they
+   * are at most one period older and their overflows are either handled or
+   * pending together with the timer value. Extending captures on their own
+   * fails for a capture just before an overflow which was handled by the
+   * previous run of the ISR. The overflow flag must be read after the timer,
+   * see Timebase_extend. */
+  channelFlags = PPD42NS_HalPendingChannels();
+  isrTime = PPD42NS_HalReadTimer();
+  overflowPending = PPD42NS_HalOverflowPending();
+  isrEntryTime = Timebase_extend(&PPD42NS_timebase, isrTime, overflowPending);
+  for (channel = 0; channelFlags; channel++, channelFlags >>= 1)
   {
-    Timer1_readCaptureCompareChannel0(&counterValue);
-    currentTimerValue = counterValue.value + PPD42NS_counterValueTotal;
-    /* Pin change from LOW -> HIGH? Sum up low occupany time */
-    if (P0_2 == Px_HIGH)
+    if (!(channelFlags & 0x01)) continue;
+    currentTimerValue = Timebase_extendCapture(isrEntryTime, isrTime, PPD42NS_HalReadCapture(channel));
+    readout = &PPD42NS_readout[channel];
+    if (PPD42NS_HalPinLevel(channel))
     {
-      /* @todo: According to datasheet max. low pulse is 90ms. Thus, we should ignore everything above? */
-      PPD42NS_sensor0.P1.counterValueLowPulseOccupancy += (currentTimerValue - PPD42NS_sensor0.P1.counterValueLowPulseOccupancystart);
+      /* Pin change from LOW -> HIGH? Sum up low occupany time. Without a
+       * preceding HIGH -> LOW edge this was lost or merged with this one */
+      if (readout->lowPulseActive)
+      {
+        readout->lowPulseActive = 0;
+        PPD42NS_lowPulseEnd(readout, currentTimerValue - readout->counterValueLowPulseOccupancystart);
+      }
+      else
+      {
+        PPD42NS_SATURATEDINCREMENT(readout->pulseStatistics.edgeErrors);
+      }
     }
-    /* Pin change from HIGH -> LOW? Remember counter value for later low occupancy time calculation */
-    if (P0_2 == Px_LOW)
+    else
     {
-      PPD42NS_sensor0.P1.counterValueLowPulseOccupancystart = currentTimerValue;
+      /* Pin change from HIGH -> LOW? Remember counter value for later low occupancy time calculation.
+       * A second HIGH -> LOW edge means the LOW -> HIGH edge in between was lost */
+      if (readout->lowPulseActive) PPD42NS_SATURATEDINCREMENT(readout->pulseStatistics.edgeErrors);
+      readout->lowPulseActive = 1;
+      readout->counterValueLowPulseOccupancystart = currentTimerValue;
     }
     /* clear source flag */
-    clearInterruptFlag(T1STAT, T1STAT_CH0IF);
+    PPD42NS_HalClearChannel(channel);
   }
-  /* Channel1 -> P0.3 */
-  if (checkInterruptFlag(T1STAT, T1STAT_CH1IF) )
+  /* Overflow must be handled last, captures above were extended relative to the previous one */
+  if (overflowPending)
   {
-    Timer1_readCaptureCompareChannel1(&counterValue);
-    currentTimerValue = counterValue.value + PPD42NS_counterValueTotal;
-    /* Pin change from LOW -> HIGH? Sum up low occupany time */
-    if (P0_3 == Px_HIGH)
+    Timebase_overflow(&PPD42NS_timebase);
+    if (++PPD42NS_bucketOverflows >= PPD42NS_config.bucketLength)
     {
-      /* @todo: According to datasheet max. low pulse is 90ms. Thus, we should ignore everything above? */
-      PPD42NS_sensor0.P2.counterValueLowPulseOccupancy += (currentTimerValue - PPD42NS_sensor0.P2.counterValueLowPulseOccupancystart);
+      PPD42NS_bucketOverflows = 0;
+      PPD42NS_closeBucket();
     }
-    /* Pin change from HIGH -> LOW? Remember counter value for later low occupancy time calculation */
-    if (P0_3 == Px_LOW)
-    {
-      PPD42NS_sensor0.P2.counterValueLowPulseOccupancystart = currentTimerValue;
-    }
-    /* clear source flag */
-    clearInterruptFlag(T1STAT, T1STAT_CH1IF);
+    PPD42NS_HalClearOverflow();
+  } 
+  /* Run time statistics, only a few cycles as the average is kept in Q4 */
+  isrTime = (uint16_t)(PPD42NS_HalReadTimer() - isrTime);
+  PPD42NS_statistics.isrCounter++;
+  if (isrTime > PPD42NS_statistics.isrMaxTime) PPD42NS_statistics.isrMaxTime = isrTime;
+  PPD42NS_statistics.isrAverageTime += (uint16_t)(isrTime - (PPD42NS_statistics.isrAverageTime >> 4));
+  /* Clear interrupt flag, will be directly set again if not all source flags were cleared */
+  PPD42NS_HalInterruptDone();
+}
+
+/**
+ * Add a complete low pulse to the current bucket. Pulses longer than
+ * PPD42NS_MAXLOWPULSE are out of spec and only counted as rejected. Valid
+ * pulses are sorted into a log2 histogram, bin n holds pulses up to
+ * 2^(n + PPD42NS_HISTOGRAMSHIFT) ticks. Called from ISR.
+ */
+static void PPD42NS_lowPulseEnd(PPD42DN_singleReadout_t *readout, uint32_t lowPulse)
+{
+  uint8_t scaledPulse;
+  uint8_t bin = 0;
+
+  if (lowPulse > PPD42NS_MAXLOWPULSE)
+  {
+    PPD42NS_SATURATEDINCREMENT(readout->pulseStatistics.rejectedPulses);
+    return;
   }
-#ifdef PPD42NS_SENSOR1CONNECTED
-  /* Channel2 -> P0.4 */
-  if (checkInterruptFlag(T1STAT, T1STAT_CH2IF) )
+  readout->counterValueLowPulseOccupancy += lowPulse;
+  scaledPulse = (uint8_t)(lowPulse >> PPD42NS_HISTOGRAMSHIFT);
+  while (scaledPulse && (bin < PPD42NS_HISTOGRAMBINS - 1))
+  {
+    scaledPulse >>= 1;
+    bin++;
+  }
+  PPD42NS_SATURATEDINCREMENT(readout->pulseStatistics.histogram[bin]);
+}
+
+/**
+ * Move low occupancy time of the current bucket into the window and publish
+ * ratio of the window. Called from ISR at the end of each bucket.
+ */
+static void PPD42NS_closeBucket(void)
+{
+  volatile PPD42NS_Snapshot_t *snapshot;
+  PPD42DN_singleReadout_t *readout;
+  uint32_t *bucket = PPD42NS_bucketLowPulseOccupancy[PPD42NS_bucketIndex];
+  uint8_t channel;
+  uint8_t bin;
+  uint8_t pulses;
+
+  if (PPD42NS_filledBuckets < PPD42NS_config.numberOfBuckets) PPD42NS_filledBuckets++;
+  /* fill the snapshot readers are not using and publish it afterwards, only
+   * integer counters are stored here, ratio is calculated by the reader */
+  snapshot = &PPD42NS_snapshot[(uint8_t)(PPD42NS_snapshotSequence + 1) & 0x01];
+  snapshot->windowTime = (uint32_t)PPD42NS_filledBuckets * PPD42NS_config.bucketLength * TIMEBASE_PERIOD;
+  snapshot->windowId = PPD42NS_snapshot[PPD42NS_snapshotSequence & 0x01].windowId + 1;
+  snapshot->flags = (PPD42NS_filledBuckets < PPD42NS_config.numberOfBuckets) ? PPD42NS_SNAPSHOTFLAG_WARMUP : 0;
+  snapshot->errorChannels = 0;
+  snapshot->silentChannels = 0;
+  for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
   {
-    Timer1_readCaptureCompareChannel2(&counterValue);
-    currentTimerValue = counterValue.value + PPD42NS_counterValueTotal;
-    /* Pin change from LOW -> HIGH? Sum up low occupany time */
-    if (P0_4 == Px_HIGH)
+    readout = &PPD42NS_readout[channel];
+    /* replace oldest bucket of the window by the current one */
+    PPD42NS_windowLowPulseOccupancy[channel] += readout->counterValueLowPulseOccupancy - bucket[channel];
+    bucket[channel] = readout->counterValueLowPulseOccupancy;
+    snapshot->lowPulseOccupancy[channel] = PPD42NS_windowLowPulseOccupancy[channel];
+    /* remember if any bucket of the window had rejected pulses or lost edges */
+    if (readout->pulseStatistics.rejectedPulses || readout->pulseStatistics.edgeErrors)
     {
-      /* @todo: According to datasheet max. low pulse is 90ms. Thus, we should ignore everything above? */
-      PPD42NS_sensor1.P1.counterValueLowPulseOccupancy += (currentTimerValue - PPD42NS_sensor1.P1.counterValueLowPulseOccupancystart);
+      readout->bucketsSinceError = 0;
     }
-    /* Pin change from HIGH -> LOW? Remember counter value for later low occupancy time calculation */
-    if (P0_4 == Px_LOW)
+    else if (readout->bucketsSinceError < PPD42NS_MAXNUMBEROFBUCKETS)
     {
-      PPD42NS_sensor1.P1.counterValueLowPulseOccupancystart = currentTimerValue;
+      readout->bucketsSinceError++;
     }
-    /* clear source flag */
-    clearInterruptFlag(T1STAT, T1STAT_CH2IF);
-  }
-  /* Channel3 -> P0.5 */
-  if (checkInterruptFlag(T1STAT, T1STAT_CH3IF) )
-  {
-    Timer1_readCaptureCompareChannel3(&counterValue);
-    currentTimerValue = counterValue.value + PPD42NS_counterValueTotal;
-    /* Pin change from LOW -> HIGH? Sum up low occupany time */
-    if (P0_5 == Px_HIGH)
+    if (readout->bucketsSinceError < PPD42NS_config.numberOfBuckets) snapshot->errorChannels |= (uint8_t)(1 << channel);
+    /* a line stuck at either level or a disconnected sensor shows no edges,
+     * i.e. no pulse ended, valid or not */
+    pulses = readout->pulseStatistics.rejectedPulses | readout->pulseStatistics.edgeErrors;
+    for (bin = 0; bin < PPD42NS_HISTOGRAMBINS; bin++)
     {
-      /* @todo: According to datasheet max. low pulse is 90ms. Thus, we should ignore everything above? */
-      PPD42NS_sensor1.P2.counterValueLowPulseOccupancy += (currentTimerValue - PPD42NS_sensor1.P2.counterValueLowPulseOccupancystart);
+      pulses |= readout->pulseStatistics.histogram[bin];
     }
-    /* Pin change from HIGH -> LOW? Remember counter value for later low occupancy time calculation */
-    if (P0_5 == Px_LOW)
+    if (pulses)
     {
-      PPD42NS_sensor1.P2.counterValueLowPulseOccupancystart = currentTimerValue;
+      readout->bucketsSincePulse = 0;
     }
-    /* clear source flag */
-    clearInterruptFlag(T1STAT, T1STAT_CH3IF);
-  }
-#endif
-  /* Overflow must be checked last in order to avoid problems when overflow and input capture happens at the same time */
-  if (checkInterruptFlag(T1STAT, T1STAT_OVFIF) )
-  {
-    PPD42NS_counterValueTotal += 0xffff;
-    if (PPD42NS_counterValueTotal > PPD42NS_TIMER1_MAX)
+    else if (readout->bucketsSincePulse < PPD42NS_SILENTBUCKETS)
     {
-      /* Calculate ratio */
-      PPD42NS_sensor0.P1.ratio = (float)PPD42NS_sensor0.P1.counterValueLowPulseOccupancy/PPD42NS_counterValueTotal;
-      PPD42NS_sensor0.P2.ratio = (float)PPD42NS_sensor0.P2.counterValueLowPulseOccupancy/PPD42NS_counterValueTotal;
-      /* reset values for next measurement */
-      PPD42NS_sensor0.P1.counterValueLowPulseOccupancy = 0;
-      PPD42NS_sensor0.P2.counterValueLowPulseOccupancy = 0;
-      PPD42NS_nextSensorValueAvailable = true;
+      readout->bucketsSincePulse++;
     }
-    clearInterruptFlag(T1STAT, T1STAT_OVFIF);
-  } 
-  /* Clear interrupt flag, will be directly set again if not all source flags were cleared */
-  T1IF = 0;
+    if (readout->bucketsSincePulse >= PPD42NS_SILENTBUCKETS) snapshot->silentChannels |= (uint8_t)(1 << channel);
+    snapshot->pulseStatistics[channel] = readout->pulseStatistics;
+    /* reset values for next bucket */
+    readout->counterValueLowPulseOccupancy = 0;
+    readout->pulseStatistics.rejectedPulses = 0;
+    readout->pulseStatistics.edgeErrors = 0;
+    for (bin = 0; bin < PPD42NS_HISTOGRAMBINS; bin++)
+    {
+      readout->pulseStatistics.histogram[bin] = 0;
+    }
+  }
+  if (snapshot->errorChannels) snapshot->flags |= PPD42NS_SNAPSHOTFLAG_EDGEERROR;
+  if (snapshot->silentChannels) snapshot->flags |= PPD42NS_SNAPSHOTFLAG_SILENT;
+  if (++PPD42NS_bucketIndex >= PPD42NS_config.numberOfBuckets) PPD42NS_bucketIndex = 0;
+  PPD42NS_HalMemoryBarrier();
+  PPD42NS_snapshotSequence++;
+  if (PPD42NS_config.windowCallback != NULL) PPD42NS_config.windowCallback();
 }
 
 /**
- * Blocking wait until new sensor value is ready.
+ * Blocking wait until new sensor value is ready, i.e. until the end of the
+ * next bucket. The MCU sleeps until the next interrupt between checks, the
+ * measurement itself runs on Timer1 interrupts only. Time slept and time awake
+ * since the previous call are recorded in the statistics, see
+ * PPD42NS_readStatistics.
  */
 void PPD42NS_waitForNextSenorValue()
 {
-  /* Assumption PPD42NS_nextSensorValueAvailable will be writte atomic */
-  while(!PPD42NS_nextSensorValueAvailable)
+  uint32_t now;
+  uint8_t sequence;
+
+  while(PPD42NS_snapshotSequence == PPD42NS_lastSnapshotSequence)
   {
-    nop();
+    now = PPD42NS_readTime();
+    PPD42NS_HalSleep();
+    PPD42NS_sleepTime += PPD42NS_readTime() - now;
   }
-  PPD42NS_nextSensorValueAvailable = false;
+  sequence = PPD42NS_snapshotSequence;
+  PPD42NS_statistics.windowOverruns += (uint8_t)(sequence - PPD42NS_lastSnapshotSequence - 1);
+  PPD42NS_lastSnapshotSequence = sequence;
+  now = PPD42NS_readTime();
+  PPD42NS_statistics.lastSleepTime = PPD42NS_sleepTime;
+  PPD42NS_statistics.lastActiveTime = now - PPD42NS_lastWaitTime - PPD42NS_sleepTime;
+  PPD42NS_lastWaitTime = now;
+  PPD42NS_sleepTime = 0;
 }
 
 /**
- * Readout function for PPD42NS sensor values. The values are transformed from
- * raw (ration between low occupancy and total length) to physical (particle/m^3).
- * For each sensor (Sensor0, Sensor1) and channel (P1, P2) a separate read-out
- * function is provided.
- * @return particle concentration in particle/m^3
+ * Get a consistent copy of the results of the last completed measurement
+ * period for all sensors and channels. Timer1 interrupt stays enabled, if a
+ * new snapshot is published while copying, the copy is repeated.
+ * @param snapshot receives the copy
  */
-void PPD42NS_readSensor0P1Value(float *value)
+void PPD42NS_readSnapshot(PPD42NS_Snapshot_t *snapshot)
 {
-  disableInterrupt(IEN1, IEN1_T1IE);
-  /* @todo transform sensor value to physical value */
-  *value = PPD42NS_sensor0.P1.ratio;
-  enableInterrupt(IEN1, IEN1_T1IE);
+  uint8_t sequence;
+
+  sequence = PPD42NS_snapshotSequence;
+  for (;;)
+  {
+    PPD42NS_HalMemoryBarrier();
+    *snapshot = PPD42NS_snapshot[sequence & 0x01];
+    PPD42NS_HalMemoryBarrier();
+    if (sequence == PPD42NS_snapshotSequence) break;
+    sequence = PPD42NS_snapshotSequence;
+    PPD42NS_statistics.snapshotRetries++;
+  }
 }
 
 /**
- * Readout function for PPD42NS sensor values. The values are transformed from
- * raw (ration between low occupancy and total length) to physical (particle/m^3).
- * For each sensor (Sensor0, Sensor1) and channel (P1, P2) a separate read-out
- * function is provided.
- * @return particle concentration in particle/m^3
+ * Get a consistent copy of the run time statistics. Like the snapshot, the
+ * copy is repeated if the ISR ran meanwhile instead of masking interrupts.
+ * @param statistics receives the copy
  */
-void PPD42NS_readSensor0P2Value(float *value)
+void PPD42NS_readStatistics(PPD42NS_Statistics_t *statistics)
 {
-  disableInterrupt(IEN1, IEN1_T1IE);
-  /* @todo transform sensor value to physical value */
-  *value = PPD42NS_sensor0.P2.ratio;
-  enableInterrupt(IEN1, IEN1_T1IE);
+  do
+  {
+    *statistics = PPD42NS_statistics;
+  } while (statistics->isrCounter != PPD42NS_statistics.isrCounter);
 }
 
-#ifdef PPD42NS_SENSOR1CONNECTED
 /**
- * Readout function for PPD42NS sensor values. The values are transformed from
- * raw (ration between low occupancy and total length) to physical (particle/m^3).
- * For each sensor (Sensor0, Sensor1) and channel (P1, P2) a separate read-out
- * function is provided.
- * @return particle concentration in particle/m^3
+ * Current Timer1 time extended to 32 bit, a common clock (1MHz) for other
+ * drivers, e.g. DHT22 edge timing. Can be called with interrupts enabled.
+ * @return Timer1 ticks since PPD42NS_init, wraps after 2^32 ticks
+ */
+uint32_t PPD42NS_readTime(void)
+{
+  return Timebase_read(&PPD42NS_timebase, &PPD42NS_timebaseCounter);
+}
+
+/**
+ * Readout function for PPD42NS low occupancy ratio of the last window.
+ * @param sensor sensor number starting with 0
+ * @param channel PPD42NS_CHANNEL_P1 or PPD42NS_CHANNEL_P2
+ * @param ratio low occupancy ratio in Q16 (0xffff ~ 100%)
+ * @return PPD42NS_OK if value was read, PPD42NS_NOT_OK if sensor or channel
+ * is not configured or the channel is silent (stuck or disconnected)
  */
-float PPD42NS_readSensor1P1Value()
+uint8_t PPD42NS_readRatio(uint8_t sensor, uint8_t channel, uint16_t *ratio)
 {
-  /* @todo transform sensor value to physical value */
-  return PPD42NS_sensor1.P1.ratio;
+  uint8_t index = sensor * PPD42NS_CHANNELSPERSENSOR + channel;
+  PPD42NS_Snapshot_t snapshot;
+
+  if ((channel >= PPD42NS_CHANNELSPERSENSOR) || (index >= PPD42NS_NUMBEROFCHANNELS)) return PPD42NS_NOT_OK;
+  PPD42NS_readSnapshot(&snapshot);
+  *ratio = PPD42NS_calculateRatio(snapshot.lowPulseOccupancy[index], snapshot.windowTime);
+  if (snapshot.silentChannels & (uint8_t)(1 << index)) return PPD42NS_NOT_OK;
+  return PPD42NS_OK;
 }
 
 /**
  * Readout function for PPD42NS sensor values. The values are transformed from
  * raw (ration between low occupancy and total length) to physical (particle/m^3).
- * For each sensor (Sensor0, Sensor1) and channel (P1, P2) a separate read-out
- * function is provided.
+ * @param sensor sensor number starting with 0
+ * @param channel PPD42NS_CHANNEL_P1 or PPD42NS_CHANNEL_P2
+ * @param value particle concentration in particle/m^3
+ * @return PPD42NS_OK if value was read, PPD42NS_NOT_OK if sensor or channel
+ * is not configured or the channel is silent
+ */
+uint8_t PPD42NS_readValue(uint8_t sensor, uint8_t channel, uint32_t *value)
+{
+  uint16_t ratio;
+
+  if (PPD42NS_readRatio(sensor, channel, &ratio) != PPD42NS_OK) return PPD42NS_NOT_OK;
+  *value = PPD42NS_calculateConcentration(ratio);
+  return PPD42NS_OK;
+}
+
+/**
+ * Ratio between low occupancy and total time without float division. Both
+ * values are scaled down until total time fits into 16 bit, the resulting
+ * 32/16 bit division keeps the full Q16 resolution and is rounded.
+ * @param lowPulseOccupancy low occupancy time
+ * @param totalTime total time in the same unit
+ * @return ratio in Q16, saturated at 0xffff
+ */
+uint16_t PPD42NS_calculateRatio(uint32_t lowPulseOccupancy, uint32_t totalTime)
+{
+  uint32_t ratio;
+
+  if (totalTime == 0) return 0;
+  while (totalTime > 0xffff)
+  {
+    totalTime >>= 1;
+    lowPulseOccupancy >>= 1;
+  }
+  if (lowPulseOccupancy >= totalTime) return 0xffff;
+  ratio = ((lowPulseOccupancy << 16) + (totalTime >> 1)) / totalTime;
+  return (uint16_t)ratio;
+}
+
+/**
+ * Transform low occupancy ratio into particle concentration using the
+ * datasheet curve, see PPD42NS_concentrationCurve. Ratios above 20% are beyond
+ * the datasheet curve and are clamped.
+ * @param ratio low occupancy ratio in Q16
  * @return particle concentration in particle/m^3
  */
-float PPD42NS_readSensor1P2Value()
+uint32_t PPD42NS_calculateConcentration(uint16_t ratio)
+{
+  /* ratio in percent, Q16: the fraction keeps the full resolution of ratio,
+   * small ratios would lose several percent in Q8 */
+  uint32_t percent = (uint32_t)ratio * 100;
+  uint8_t index = (uint8_t)(percent >> 16);
+  uint16_t fraction = (uint16_t)percent;
+  uint16_t concentration;
+
+  if (index >= PPD42NS_CONCENTRATIONCURVEPOINTS - 1)
+  {
+    concentration = PPD42NS_concentrationCurve[PPD42NS_CONCENTRATIONCURVEPOINTS - 1];
+  }
+  else
+  {
+    concentration = PPD42NS_concentrationCurve[index] + (uint16_t)(((uint32_t)(PPD42NS_concentrationCurve[index + 1] - PPD42NS_concentrationCurve[index]) * fraction + 0x8000) >> 16);
+  }
+  /* particles/0.01cf * 2 -> particles/m^3: 3531.47 / 2 = 56503 / 32 */
+  return ((uint32_t)concentration * 56503) >> 5;
+}
+
+/**
+ * Timer1 access for PPD42NS_timebaseCounter
+ */
+static uint16_t PPD42NS_readTimer(void)
+{
+  return PPD42NS_HalReadTimer();
+}
+
+static uint8_t PPD42NS_overflowPending(void)
 {
-  /* @todo transform sensor value to physical value */
-  return PPD42NS_sensor1.P2.ratio;
+  return PPD42NS_HalOverflowPending() ? 1 : 0;
 }
-#endif
\ No newline at end of file
@@ -24,43 +24,177 @@
 */
 /*******************| Inclusions |*************************************/
 #include <PlatformTypes.h>
+/* configuration decides on the number of sensors, thus included here */
+#include "Config.h"
    
 /*******************| Macros |*****************************************/
 /**
- * Measuring time. Time depends on Timer1 speed which is set to 1MHz in 
- * PPD42NS_init function 
+ * Default measuring time (window). Time depends on Timer1 speed which is set to
+ * 1MHz in PPD42NS_init function 
  */
-#define PPD42NS_TIMER1_MAX      ((uint32_t)30 * 1000000)
+#if (!defined PPD42NS_TIMER1_MAX)
+#define PPD42NS_TIMER1_MAX      30000000UL
+#endif
+
+/**
+ * The window is made of buckets, a new ratio over the window is available at
+ * the end of each bucket. Bucket length is given in Timer1 overflows of
+ * 65.536ms, default is ~1s.
+ */
+#define PPD42NS_MAXNUMBEROFBUCKETS      32
+#if (!defined PPD42NS_DEFAULTBUCKETLENGTH)
+#define PPD42NS_DEFAULTBUCKETLENGTH     15
+#endif
+#define PPD42NS_DEFAULTNUMBEROFBUCKETS  (PPD42NS_TIMER1_MAX / (PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL))
+
+/* Configuration is checked here as the window is accumulated in 8 bit bucket
+ * counters and 32 bit tick counters */
+#if (PPD42NS_DEFAULTBUCKETLENGTH < 1) || (PPD42NS_DEFAULTBUCKETLENGTH > 0xff)
+#error "PPD42NS_DEFAULTBUCKETLENGTH must be 1..255 Timer1 overflows"
+#endif
+#if (PPD42NS_DEFAULTNUMBEROFBUCKETS < 1) || (PPD42NS_DEFAULTNUMBEROFBUCKETS > PPD42NS_MAXNUMBEROFBUCKETS)
+#error "PPD42NS_TIMER1_MAX must be 1..PPD42NS_MAXNUMBEROFBUCKETS buckets of PPD42NS_DEFAULTBUCKETLENGTH"
+#endif
+#if ((PPD42NS_MAXNUMBEROFBUCKETS * 0xffUL * 0x10000UL) > 0xffffffffUL)
+#error "PPD42NS_MAXNUMBEROFBUCKETS too large, longest window exceeds 32 bit Timer1 ticks"
+#endif
+
+/* Snapshot flags */
+#define PPD42NS_SNAPSHOTFLAG_WARMUP     0x01    /**< window not yet completely filled since init */
+#define PPD42NS_SNAPSHOTFLAG_EDGEERROR  0x02    /**< a channel had rejected pulses or lost edges within the window */
+#define PPD42NS_SNAPSHOTFLAG_SILENT     0x04    /**< a channel had no low pulse for PPD42NS_SILENTBUCKETS buckets */
+
+/**
+ * Number of buckets without any low pulse after which a channel is considered
+ * disconnected or stuck (ratio of exactly 0 or 1), default is ~1 minute.
+ */
+#if (!defined PPD42NS_SILENTBUCKETS)
+#define PPD42NS_SILENTBUCKETS           60
+#endif
+#if (PPD42NS_SILENTBUCKETS < 1) || (PPD42NS_SILENTBUCKETS > 0xfe)
+#error "PPD42NS_SILENTBUCKETS must be 1..254"
+#endif
+
+/**
+ * According to datasheet max. low pulse is 90ms, longer pulses are ignored.
+ */
+#if (!defined PPD42NS_MAXLOWPULSE)
+#define PPD42NS_MAXLOWPULSE             90000UL
+#endif
+
+/**
+ * Low pulse histogram: bin 0 holds pulses shorter than 2^PPD42NS_HISTOGRAMSHIFT
+ * ticks (~1ms), each further bin doubles the length, the last one ends at
+ * PPD42NS_MAXLOWPULSE.
+ */
+#define PPD42NS_HISTOGRAMSHIFT          10
+#define PPD42NS_HISTOGRAMBINS           8
+#if (PPD42NS_MAXLOWPULSE >= (0x100UL << PPD42NS_HISTOGRAMSHIFT))
+#error "PPD42NS_MAXLOWPULSE too long for histogram"
+#endif
+
+#if (!defined PPD42NS_OK)
+#define PPD42NS_OK              0
+#endif
+
+#if (!defined PPD42NS_NOT_OK)
+#define PPD42NS_NOT_OK          1
+#endif
+
+/**
+ * Each sensor uses two consecutive Timer1 input capture channels, P1 on the
+ * even and P2 on the odd one.
+ */
+#define PPD42NS_CHANNEL_P1              0
+#define PPD42NS_CHANNEL_P2              1
+#define PPD42NS_CHANNELSPERSENSOR       2
+
+/**
+ * Number of Timer1 input capture channels used, channel n is connected to
+ * P0.(n+2). Timer1 has five channels, thus channel 4 can only be used for P1
+ * of a third sensor.
+ */
+#define PPD42NS_MAXNUMBEROFCHANNELS     5
+#if (!defined PPD42NS_NUMBEROFCHANNELS)
+#ifdef PPD42NS_SENSOR1CONNECTED
+#define PPD42NS_NUMBEROFCHANNELS        4
+#else
+#define PPD42NS_NUMBEROFCHANNELS        2
+#endif
+#endif
+#if (PPD42NS_NUMBEROFCHANNELS < 1) || (PPD42NS_NUMBEROFCHANNELS > PPD42NS_MAXNUMBEROFCHANNELS)
+#error "PPD42NS_NUMBEROFCHANNELS must be 1..5"
+#endif
+#define PPD42NS_NUMBEROFSENSORS         ((PPD42NS_NUMBEROFCHANNELS + 1) / PPD42NS_CHANNELSPERSENSOR)
+
+/* T1STAT source flags of the used channels, CH0IF..CH4IF are bit 0..4 */
+#define PPD42NS_CHANNELFLAGS            ((uint8_t)((1 << PPD42NS_NUMBEROFCHANNELS) - 1))
 
 /*******************| Type definitions |*******************************/
 typedef struct {
-  uint8_t t;
+  uint8_t bucketLength;                         /**< Timer1 overflows per bucket, at least 1 */
+  uint8_t numberOfBuckets;                      /**< buckets per window, 1..PPD42NS_MAXNUMBEROFBUCKETS */
+  void (*windowCallback)(void);                 /**< called from ISR after each new snapshot, may be NULL */
 } PPD42NS_Config_t;
 
+/**
+ * Pulse statistics of one channel during one bucket, all counters saturate at 255
+ */
+typedef struct {
+  uint8_t histogram[PPD42NS_HISTOGRAMBINS];     /**< number of valid low pulses per length, see PPD42NS_HISTOGRAMSHIFT */
+  uint8_t rejectedPulses;                       /**< low pulses longer than PPD42NS_MAXLOWPULSE */
+  uint8_t edgeErrors;                           /**< edges lost or merged, e.g. two HIGH -> LOW edges in a row */
+} PPD42NS_PulseStatistics_t;
+
 typedef struct {
   uint32_t counterValueLowPulseOccupancystart;  /**< Time for trailing edge (HIGH -> LOW) */
   uint32_t counterValueLowPulseOccupancy;       /**< total low occupancy time for */  
-  float ratio;
+  PPD42NS_PulseStatistics_t pulseStatistics;    /**< statistics of current bucket */
+  uint8_t lowPulseActive;                       /**< trailing edge seen, waiting for leading edge */
+  uint8_t bucketsSinceError;                    /**< buckets since pulseStatistics showed an error */
+  uint8_t bucketsSincePulse;                    /**< buckets since the last low pulse ended */
 } PPD42DN_singleReadout_t;
 
+/**
+ * Result of one measurement period (window) for all sensors and channels
+ */
+typedef struct {
+  uint16_t windowId;                            /**< number of the measurement period */
+  uint8_t flags;                                /**< PPD42NS_SNAPSHOTFLAG_xxx */
+  uint32_t windowTime;                          /**< length of the window in Timer1 ticks */
+  uint32_t lowPulseOccupancy[PPD42NS_NUMBEROFCHANNELS]; /**< low occupancy time in window, index sensor * PPD42NS_CHANNELSPERSENSOR + PPD42NS_CHANNEL_Px */
+  PPD42NS_PulseStatistics_t pulseStatistics[PPD42NS_NUMBEROFCHANNELS]; /**< statistics of the newest bucket of the window */
+  uint8_t errorChannels;                        /**< one bit per channel with errors within the window */
+  uint8_t silentChannels;                       /**< one bit per channel without low pulse for PPD42NS_SILENTBUCKETS buckets */
+} PPD42NS_Snapshot_t;
+
+/**
+ * Run time statistics of the driver, always enabled, see PPD42NS_readStatistics
+ */
 typedef struct {
-  PPD42DN_singleReadout_t P1;                   /**< Values for P1 (1um) */  
-  PPD42DN_singleReadout_t P2;                   /**< Values for P2 (2.5um) */  
-} PPD42DN_sensorValues_t;
+  uint32_t isrCounter;                          /**< PPD42NS_inputCaptureISR entries */
+  uint16_t isrMaxTime;                          /**< longest ISR run in Timer1 ticks */
+  uint16_t isrAverageTime;                      /**< moving average (1/16) of ISR run time in Timer1 ticks, Q4 */
+  uint16_t windowOverruns;                      /**< windows published but missed by PPD42NS_waitForNextSenorValue */
+  uint16_t snapshotRetries;                     /**< snapshot copies repeated as a new window was published meanwhile */
+  uint32_t lastSleepTime;                       /**< Timer1 ticks slept in PPD42NS_waitForNextSenorValue since its previous return, incl. interrupts waking the MCU */
+  uint32_t lastActiveTime;                      /**< Timer1 ticks spent outside of PPD42NS_waitForNextSenorValue in the same period */
+} PPD42NS_Statistics_t;
 
 /*******************| Type definitions |*******************************/
 
 /*******************| Global variables |*******************************/
 
 /*******************| Function prototypes |****************************/
-void PPD42NS_init();
+void PPD42NS_init(const PPD42NS_Config_t *config);
 void PPD42NS_waitForNextSenorValue();
-void PPD42NS_readSensor0P1Value(float *value);
-void PPD42NS_readSensor0P2Value(float *value);
-#ifdef PPD42NS_SENSOR1CONNECTED
-float PPD42NS_readSensor1P1Value();
-float PPD42NS_readSensor1P2Value();
-#endif
+void PPD42NS_readSnapshot(PPD42NS_Snapshot_t *snapshot);
+void PPD42NS_readStatistics(PPD42NS_Statistics_t *statistics);
+uint32_t PPD42NS_readTime(void);
+uint8_t PPD42NS_readRatio(uint8_t sensor, uint8_t channel, uint16_t *ratio);
+uint8_t PPD42NS_readValue(uint8_t sensor, uint8_t channel, uint32_t *value);
+uint16_t PPD42NS_calculateRatio(uint32_t lowPulseOccupancy, uint32_t totalTime);
+uint32_t PPD42NS_calculateConcentration(uint16_t ratio);
 
 #endif
 /** @}*/
\ No newline at end of file
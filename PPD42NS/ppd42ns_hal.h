@@ -0,0 +1,40 @@
+/** @ingroup PPD42NS
+ * @{
+ */
+#ifndef PPD42NS_HAL_H_
+#define PPD42NS_HAL_H_
+/**
+ * Hardware abstraction for the PPD42NS driver. A backend provides a free
+ * running 16 bit timer with 1MHz and input capture on both edges for channels
+ * 0..PPD42NS_NUMBEROFCHANNELS-1, all events ending up in
+ * PPD42NS_inputCaptureISR:
+ * - void PPD42NS_halInit(uint8_t numberOfChannels): configure capture channels,
+ *   overflow interrupt and start timer
+ * - PPD42NS_HalPendingChannels(): bit mask of channels with capture event
+ * - PPD42NS_HalReadCapture(channel): captured timer value
+ * - PPD42NS_HalReadTimer(): current timer value, for ISR run time statistics
+ * - PPD42NS_HalPinLevel(channel): not 0 if input of channel is high
+ * - PPD42NS_HalClearChannel(channel): clear capture event of channel
+ * - PPD42NS_HalOverflowPending(), PPD42NS_HalClearOverflow(): timer overflow
+ * - PPD42NS_HalInterruptDone(): clear interrupt flag at end of ISR
+ * - PPD42NS_HalSleep(): wait for next interrupt
+ * - PPD42NS_HalMemoryBarrier(): keep memory accesses of the snapshot from being
+ *   reordered across it, by the compiler and if needed by the CPU
+ * - PPD42NS_ISR: attributes placing PPD42NS_inputCaptureISR in the vector table
+ * The CC2530 backend is used unless PPD42NS_HAL_HOST is defined, the host
+ * backend runs on simulated time, see ppd42ns_hal_host.h.
+*/
+
+/*******************| Inclusions |*************************************/
+#include "ppd42ns.h"
+#ifdef PPD42NS_HAL_HOST
+#include "ppd42ns_hal_host.h"
+#else
+#include "ppd42ns_hal_cc2530.h"
+#endif
+
+/*******************| Function prototypes |****************************/
+void PPD42NS_halInit(uint8_t numberOfChannels);
+
+#endif
+/** @}*/
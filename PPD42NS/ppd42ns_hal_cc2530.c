@@ -0,0 +1,128 @@
+/*******************| Inclusions |*************************************/
+#include "ppd42ns_hal.h"
+
+#ifndef PPD42NS_HAL_HOST
+/**
+ * @brief CC2530 Timer1 backend for PPD42NS module
+ * Timer1 input capture units will be used, channel0 -> P0.2, channel1 -> P0.3,
+ * channel2 -> P0.4, channel3 -> P0.5, channel4 -> P0.6
+*/
+
+/*******************| Macros |*****************************************/
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Global variables |*******************************/
+/**
+ * Capture channel table, channel n is connected to P0.(n+2). Only the first
+ * PPD42NS_NUMBEROFCHANNELS entries are used.
+ */
+const PPD42NS_halChannelConfig_t PPD42NS_halChannelConfig[PPD42NS_MAXNUMBEROFCHANNELS] = {
+  { T1STAT_CH0IF, P0SEL_SELP0_2_PERIPHERALFUNCTION },
+  { T1STAT_CH1IF, P0SEL_SELP0_3_PERIPHERALFUNCTION },
+  { T1STAT_CH2IF, P0SEL_SELP0_4_PERIPHERALFUNCTION },
+  { T1STAT_CH3IF, P0SEL_SELP0_5_PERIPHERALFUNCTION },
+  { T1STAT_CH4IF, P0SEL_SELP0_6_PERIPHERALFUNCTION }
+};
+
+/*******************| Function definition |****************************/
+/**
+ * Configure Timer1 input capture on both edges for the given number of
+ * channels and start timer with 1MHz.
+ */
+void PPD42NS_halInit(uint8_t numberOfChannels)
+{
+  uint8_t channel;
+
+  PERCFG |= PERCFG_T1CFG_ALT1;
+  
+  /* Set priority of peripherals to 
+   * 1st priority: Timer 1 channels 0-1
+   * 2nd priority: USART 1
+   * 3rd priority: USART 0
+   * 4th priority: Timer 1 channels 2-3 */
+  P2DIR = P2DIR_PRIP0_TIMER1CH01USART1USART0TIMER1CH23;
+  
+  for (channel = 0; channel < numberOfChannels; channel++)
+  {
+    /* No need to configure PIN direction because "When a channel is configured as an input 
+     * capture channel, the I/O pin associated with that channel is configured as an input."
+     * However, "Before an I/O pin can be used by the timer, the required I/O pin must be 
+     * configured as a Timer 1 peripheral pin."
+     */
+    P0SEL |= PPD42NS_halChannelConfig[channel].pinMask;
+    /* Enable capture on both edges including interrupt */
+    switch (channel)
+    {
+      case 0:
+        Timer1_captureCompareChannel0(T1CCTL0_IM | T1CCTL0_MODE_CAPTUREMODE | T1CCTL0_CAP_CAPTUREONALL);
+        break;
+      case 1:
+        Timer1_captureCompareChannel1(T1CCTL1_IM | T1CCTL1_MODE_CAPTUREMODE | T1CCTL1_CAP_CAPTUREONALL);
+        break;
+      case 2:
+        Timer1_captureCompareChannel2(T1CCTL2_IM | T1CCTL2_MODE_CAPTUREMODE | T1CCTL2_CAP_CAPTUREONALL);
+        break;
+      case 3:
+        Timer1_captureCompareChannel3(T1CCTL3_IM | T1CCTL3_MODE_CAPTUREMODE | T1CCTL3_CAP_CAPTUREONALL);
+        break;
+      default:
+        Timer1_captureCompareChannel4(T1CCTL4_IM | T1CCTL4_MODE_CAPTUREMODE | T1CCTL4_CAP_CAPTUREONALL);
+        break;
+    }
+  }
+  
+  /* Enable timer 1 overflow interrupt */
+  enableInterrupt(TIMIF, TIMIF_OVFIM);
+  enableInterrupt(IEN1, IEN1_T1IE);
+  
+  /* Start timer1 with 1MHz (Divide by 32) and start timer 1 in free running mode */
+  Timer1_startSynchronous(T1CTL_DIV_DIV32 | T1CTL_MODE_FREERUNNING, 0x0000);  
+}
+
+/**
+ * Read captured timer value of the given Timer1 channel.
+ */
+uint16_t PPD42NS_halReadCapture(uint8_t channel)
+{
+  Timer1_t counterValue;
+
+  switch (channel)
+  {
+    case 0:
+      Timer1_readCaptureCompareChannel0(&counterValue);
+      break;
+    case 1:
+      Timer1_readCaptureCompareChannel1(&counterValue);
+      break;
+    case 2:
+      Timer1_readCaptureCompareChannel2(&counterValue);
+      break;
+    case 3:
+      Timer1_readCaptureCompareChannel3(&counterValue);
+      break;
+    default:
+      Timer1_readCaptureCompareChannel4(&counterValue);
+      break;
+  }
+  return counterValue.value;
+}
+
+/**
+ * Read Timer1 counter. Reading T1CNTL latches T1CNTH, thus low byte first.
+ * An interrupt reading the counter in between would latch T1CNTH again, thus
+ * both reads are done with interrupts masked. Also called from the ISR.
+ */
+uint16_t PPD42NS_halReadTimer(void)
+{
+  uint8_t interruptsEnabled = EA;
+  uint8_t low;
+  uint8_t high;
+
+  EA = 0;
+  low = T1CNTL;
+  high = T1CNTH;
+  EA = interruptsEnabled;
+  return ((uint16_t)high << 8) | low;
+}
+#endif
@@ -0,0 +1,56 @@
+/** @ingroup PPD42NS
+ * @{
+ */
+#ifndef PPD42NS_HAL_CC2530_H_
+#define PPD42NS_HAL_CC2530_H_
+
+/*******************| Inclusions |*************************************/
+#include <ioCC2530.h>
+#include <CC253x.h>
+#include <Timer1.h>
+
+/*******************| Macros |*****************************************/
+/* The status register, T1STAT, contains the source interrupt flags for the
+ * terminal-count value event and the five channel compare/capture events. A
+ * source interrupt flag is set when the corresponding event occurs, regardless
+ * of interrupt mask bits. */
+#define PPD42NS_HalPendingChannels()            (T1STAT & PPD42NS_CHANNELFLAGS)
+#define PPD42NS_HalReadCapture(channel)         PPD42NS_halReadCapture(channel)
+#define PPD42NS_HalReadTimer()                  PPD42NS_halReadTimer()
+#define PPD42NS_HalPinLevel(channel)            (P0 & PPD42NS_halChannelConfig[channel].pinMask)
+#define PPD42NS_HalClearChannel(channel)        clearInterruptFlag(T1STAT, PPD42NS_halChannelConfig[channel].statusFlag)
+#define PPD42NS_HalOverflowPending()            checkInterruptFlag(T1STAT, T1STAT_OVFIF)
+#define PPD42NS_HalClearOverflow()              clearInterruptFlag(T1STAT, T1STAT_OVFIF)
+#define PPD42NS_HalInterruptDone()              (T1IF = 0)
+#define PPD42NS_ISR                             _Pragma("vector = T1_VECTOR") __near_func __interrupt
+/* single core executing in order, volatile accesses are not reordered by the
+ * compiler */
+#define PPD42NS_HalMemoryBarrier()
+
+/* PCON.IDLE enters the power mode selected in SLEEPCMD, in PM0 the CPU halts
+ * until the next interrupt. As the Timer1 overflow interrupt is always running,
+ * a sensor value published right before sleeping delays the wake-up by at most
+ * one overflow. PM1..PM3 stop the 32MHz clock and thus Timer1, PM0 is selected
+ * explicitly as the window must keep running. */
+#if (!defined PPD42NS_HalSleep)
+#define PPD42NS_HalSleep()                      do { SLEEPCMD &= ~0x03; PCON = 0x01; } while (0)
+#endif
+
+/*******************| Type definitions |*******************************/
+/**
+ * Timer1 capture channel description
+ */
+typedef struct {
+  uint8_t statusFlag;                           /**< source interrupt flag in T1STAT */
+  uint8_t pinMask;                              /**< P0 pin connected to the channel */
+} PPD42NS_halChannelConfig_t;
+
+/*******************| Global variables |*******************************/
+extern const PPD42NS_halChannelConfig_t PPD42NS_halChannelConfig[PPD42NS_MAXNUMBEROFCHANNELS];
+
+/*******************| Function prototypes |****************************/
+uint16_t PPD42NS_halReadCapture(uint8_t channel);
+uint16_t PPD42NS_halReadTimer(void);
+
+#endif
+/** @}*/
@@ -0,0 +1,153 @@
+/*******************| Inclusions |*************************************/
+#include "ppd42ns_hal.h"
+
+#ifdef PPD42NS_HAL_HOST
+/*******************| Macros |*****************************************/
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static void PPD42NS_hostCaptureEdge(uint8_t channel, uint8_t level, uint16_t timestamp);
+
+/*******************| Global variables |*******************************/
+uint32_t PPD42NS_hostTime;
+uint8_t PPD42NS_hostPendingChannels;
+uint8_t PPD42NS_hostPins;
+uint8_t PPD42NS_hostOverflowPending;
+uint16_t PPD42NS_hostCapture[PPD42NS_MAXNUMBEROFCHANNELS];
+void (*PPD42NS_hostBarrierHook)(void);
+
+/**
+ * State of the jitter generator, fixed seed keeps replays reproducible
+ */
+static uint32_t PPD42NS_hostRandomState;
+
+/*******************| Function definition |****************************/
+void PPD42NS_halInit(uint8_t numberOfChannels)
+{
+  uint8_t channel;
+
+  PPD42NS_hostTime = 0;
+  PPD42NS_hostRandomState = 1;
+  PPD42NS_hostPendingChannels = 0;
+  PPD42NS_hostOverflowPending = 0;
+  /* inputs are pulled up, i.e. no particle */
+  PPD42NS_hostPins = PPD42NS_CHANNELFLAGS;
+  for (channel = 0; channel < numberOfChannels; channel++)
+  {
+    PPD42NS_hostCapture[channel] = 0;
+  }
+}
+
+/**
+ * Simulate an edge on a capture channel.
+ * @param channel capture channel
+ * @param level new level of the input, 0 for LOW
+ * @param timestamp timer value at the edge
+ */
+void PPD42NS_hostEdge(uint8_t channel, uint8_t level, uint16_t timestamp)
+{
+  PPD42NS_hostTime = (PPD42NS_hostTime & 0xffff0000UL) | timestamp;
+  PPD42NS_hostCaptureEdge(channel, level, timestamp);
+  PPD42NS_inputCaptureISR();
+}
+
+/**
+ * Simulate a timer overflow.
+ */
+void PPD42NS_hostOverflow(void)
+{
+  PPD42NS_hostTime = (PPD42NS_hostTime | 0xffffUL) + 1;
+  PPD42NS_hostOverflowPending = 1;
+  PPD42NS_inputCaptureISR();
+}
+
+/**
+ * Nothing will happen while the host waits, let simulated time advance by one
+ * timer overflow instead.
+ */
+void PPD42NS_hostSleep(void)
+{
+  PPD42NS_hostOverflow();
+}
+
+/**
+ * Memory barrier of the host CPU, then the test hook if one is set.
+ */
+void PPD42NS_hostMemoryBarrier(void)
+{
+  __sync_synchronize();
+  if (PPD42NS_hostBarrierHook != NULL) PPD42NS_hostBarrierHook();
+}
+
+/**
+ * Let simulated time advance, an overflow interrupt is generated for every
+ * timer wrap around.
+ * @param time simulated timer value incl. overflows
+ */
+void PPD42NS_hostRunUntil(uint32_t time)
+{
+  while ((time >> 16) > (PPD42NS_hostTime >> 16))
+  {
+    PPD42NS_hostOverflow();
+  }
+  if (time > PPD42NS_hostTime) PPD42NS_hostTime = time;
+}
+
+/**
+ * Replay a recorded trace through the ISR, trace channel n is capture channel
+ * n. Timestamps are distorted by Trace_distortTimestamp, edges reordered by
+ * jitter are delivered in their original order at the time of the previous
+ * edge. With latency the ISR runs after the capture, a timer overflow in
+ * between is then pending together with the capture event as it happens on
+ * the target.
+ * @param trace edges sorted by timestamp
+ * @param numberOfEvents number of edges
+ * @param distortion skew, jitter and latency, may be NULL for an exact replay
+ */
+void PPD42NS_hostReplay(const Trace_Event_t *trace, uint16_t numberOfEvents, const Trace_Distortion_t *distortion)
+{
+  uint32_t start = PPD42NS_hostTime;
+  uint32_t time;
+  uint16_t event;
+
+  for (event = 0; event < numberOfEvents; event++, trace++)
+  {
+    if (trace->channel >= PPD42NS_NUMBEROFCHANNELS) continue;
+    time = start + Trace_distortTimestamp(distortion, trace->timestamp, &PPD42NS_hostRandomState);
+    if (time < PPD42NS_hostTime) time = PPD42NS_hostTime;
+    PPD42NS_hostRunUntil(time);
+    PPD42NS_hostCaptureEdge(trace->channel, trace->level, (uint16_t)time);
+    if ((distortion != NULL) && (distortion->latency))
+    {
+      time += distortion->latency;
+      if ((time >> 16) > (PPD42NS_hostTime >> 16))
+      {
+        /* timer wraps before the ISR is entered */
+        PPD42NS_hostTime = (PPD42NS_hostTime | 0xffffUL) + 1;
+        PPD42NS_hostOverflowPending = 1;
+      }
+      PPD42NS_hostRunUntil(time);
+    }
+    PPD42NS_inputCaptureISR();
+  }
+}
+
+/**
+ * Set pin level, capture register and capture flag like the capture unit does
+ */
+static void PPD42NS_hostCaptureEdge(uint8_t channel, uint8_t level, uint16_t timestamp)
+{
+  PPD42NS_hostCapture[channel] = timestamp;
+  if (level)
+  {
+    PPD42NS_hostPins |= (uint8_t)(1 << channel);
+  }
+  else
+  {
+    PPD42NS_hostPins &= (uint8_t)~(1 << channel);
+  }
+  PPD42NS_hostPendingChannels |= (uint8_t)(1 << channel);
+}
+
+#endif
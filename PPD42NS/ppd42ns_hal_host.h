@@ -0,0 +1,54 @@
+/** @ingroup PPD42NS
+ * @{
+ */
+#ifndef PPD42NS_HAL_HOST_H_
+#define PPD42NS_HAL_HOST_H_
+/**
+ * Host backend for PPD42NS module. Timer and pins are plain variables, time
+ * only advances through PPD42NS_hostEdge and PPD42NS_hostOverflow which update
+ * them and call PPD42NS_inputCaptureISR like the hardware would. Thus, runs are
+ * deterministic and recorded edges can be fed into the driver on a PC.
+ * PPD42NS_hostReplay feeds a recorded trace (see trace.h) with optional clock
+ * skew, jitter and interrupt latency, timer overflows are generated from the
+ * trace timestamps. PPD42NS_hostBarrierHook lets tests act at the memory
+ * barriers of the driver, e.g. publish a window while a snapshot is copied.
+*/
+
+/*******************| Inclusions |*************************************/
+#include "trace.h"
+
+/*******************| Macros |*****************************************/
+#define PPD42NS_HalPendingChannels()            (PPD42NS_hostPendingChannels & PPD42NS_CHANNELFLAGS)
+#define PPD42NS_HalReadCapture(channel)         (PPD42NS_hostCapture[channel])
+#define PPD42NS_HalReadTimer()                  ((uint16_t)PPD42NS_hostTime)
+#define PPD42NS_HalPinLevel(channel)            (PPD42NS_hostPins & (uint8_t)(1 << (channel)))
+#define PPD42NS_HalClearChannel(channel)        (PPD42NS_hostPendingChannels &= (uint8_t)~(1 << (channel)))
+#define PPD42NS_HalOverflowPending()            (PPD42NS_hostOverflowPending)
+#define PPD42NS_HalClearOverflow()              (PPD42NS_hostOverflowPending = 0)
+#define PPD42NS_HalInterruptDone()
+#define PPD42NS_ISR
+/* the ISR may run in another thread, e.g. in stress tests */
+#define PPD42NS_HalMemoryBarrier()              PPD42NS_hostMemoryBarrier()
+#if (!defined PPD42NS_HalSleep)
+#define PPD42NS_HalSleep()                      PPD42NS_hostSleep()
+#endif
+
+/*******************| Global variables |*******************************/
+extern uint32_t PPD42NS_hostTime;               /**< simulated timer value incl. overflows */
+extern uint8_t PPD42NS_hostPendingChannels;     /**< simulated capture flags, bit per channel */
+extern uint8_t PPD42NS_hostPins;                /**< simulated input levels, bit per channel */
+extern uint8_t PPD42NS_hostOverflowPending;     /**< simulated overflow flag */
+extern uint16_t PPD42NS_hostCapture[PPD42NS_MAXNUMBEROFCHANNELS];  /**< simulated capture registers */
+extern void (*PPD42NS_hostBarrierHook)(void);   /**< called at every memory barrier of the driver, may be NULL */
+
+/*******************| Function prototypes |****************************/
+void PPD42NS_inputCaptureISR(void);
+void PPD42NS_hostEdge(uint8_t channel, uint8_t level, uint16_t timestamp);
+void PPD42NS_hostOverflow(void);
+void PPD42NS_hostSleep(void);
+void PPD42NS_hostMemoryBarrier(void);
+void PPD42NS_hostRunUntil(uint32_t time);
+void PPD42NS_hostReplay(const Trace_Event_t *trace, uint16_t numberOfEvents, const Trace_Distortion_t *distortion);
+
+#endif
+/** @}*/
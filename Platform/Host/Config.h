@@ -0,0 +1,17 @@
+/** @ingroup Platform
+ * @{
+ */
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+/**
+ * Board configuration of the host build: two PPD42NS sensors, i.e. four
+ * capture channels, to cover the multi sensor paths in the tests.
+ */
+
+/*******************| Macros |*****************************************/
+#define PPD42NS_SENSOR1CONNECTED
+
+#endif
+/** @}*/
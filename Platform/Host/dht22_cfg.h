@@ -0,0 +1,46 @@
+/** @ingroup Platform
+ * @{
+ */
+
+#ifndef DHT22_CFG_H_
+#define DHT22_CFG_H_
+
+/**
+ * DHT22 configuration of the host build. The data line of the single sensor
+ * API is line 0 of the host backend, delays and edge capture run on its
+ * simulated time, see dht22_hal_host.h. Each wait loop iteration reads the
+ * line once and takes DHT22_HOSTREADTIME us.
+ */
+
+/*******************| Macros |*****************************************/
+#define DHT22_DATALINE_LOW                      0
+#define DHT22_DATALINE_HIGH                     1
+
+#define DHT22_ReadDataBit()                     DHT22_hostReadLine(0)
+#define DHT22_SetDataLineOutput()               DHT22_hostSetOutput(0, 1)
+#define DHT22_SetDataLineInput()                DHT22_hostSetOutput(0, 0)
+#define DHT22_WriteDataBitHigh()                DHT22_hostWriteLine(0, DHT22_DATALINE_HIGH)
+#define DHT22_WriteDataBitLow()                 DHT22_hostWriteLine(0, DHT22_DATALINE_LOW)
+#define DHT22_DelayUs(us)                       DHT22_hostDelay(us)
+#define DHT22_EnableEdgeCapture(handle)         DHT22_hostEnableCapture(handle)
+#define DHT22_DisableEdgeCapture(handle)        DHT22_hostDisableCapture(handle)
+
+/* start signal in us, wait loop timeout and zero/one split in loop counts:
+ * a zero bit is high for 26-28us, a one bit for 70us */
+#define DHT22_MCUSendStartSignalTime            1000
+#define DHT22_MCUWaitForSensorResponse          200
+#define DHT22_MCUWaitForSensorSendZero          48
+
+#define DHT22_TemperaturInvalidValue            0x7fff
+#define DHT22_RelativeHumidityInvalidValue      0xffff
+
+/*******************| Function prototypes |****************************/
+uint8_t DHT22_hostReadLine(uint8_t line);
+void DHT22_hostSetOutput(uint8_t line, uint8_t output);
+void DHT22_hostWriteLine(uint8_t line, uint8_t level);
+void DHT22_hostDelay(uint16_t us);
+void DHT22_hostEnableCapture(void *handle);
+void DHT22_hostDisableCapture(void *handle);
+
+#endif
+/** @}*/
@@ -0,0 +1,18 @@
+/** @ingroup Platform
+ * @{
+ */
+
+#ifndef GP2Y1050_CFG_H_
+#define GP2Y1050_CFG_H_
+
+/**
+ * GP2Y1050 configuration of the host build. The pulse timer macros keep their
+ * defaults, i.e. the host backend with its simulated ADC, see
+ * gp2y1050_hal_host.h. Samples can also be fed through GP2Y1050_adcCallback
+ * directly while a burst runs.
+ */
+
+/*******************| Macros |*****************************************/
+
+#endif
+/** @}*/
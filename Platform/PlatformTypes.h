@@ -0,0 +1,23 @@
+/** @ingroup Platform
+ * @{
+ */
+
+#ifndef PLATFORMTYPES_H_
+#define PLATFORMTYPES_H_
+
+/**
+ * Basic types used by all modules. IAR for 8051 and the host compilers both
+ * provide the C99 fixed width types, signed types are named sintN_t.
+ */
+
+/*******************| Inclusions |*************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************| Type definitions |*******************************/
+typedef int8_t sint8_t;
+typedef int16_t sint16_t;
+typedef int32_t sint32_t;
+
+#endif
+/** @}*/
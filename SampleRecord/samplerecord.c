@@ -0,0 +1,242 @@
+/*******************| Inclusions |*************************************/
+#include "samplerecord.h"
+
+/**
+ * @brief Packed sample records for batched transmission
+ * Samples of all sensors are collected in a RAM ring buffer and encoded into
+ * one byte stream per transmission. An encoded record consists of
+ * - header: sensor id (bit 0..4), status present (bit 5), time delta present
+ *   (bit 6)
+ * - time delta to the previous record as unsigned varint
+ * - value delta to the previous value of the same sensor id as zigzag varint
+ * - status byte
+ * Varints store 7 bit per byte, least significant first, bit 7 set if more
+ * bytes follow. Slowly changing values sampled together thus take 2-4 bytes
+ * instead of 10. The same functions decode the stream on the receiving side.
+*/
+
+/*******************| Macros |*****************************************/
+#define SAMPLERECORD_VARINTCONTINUE             0x80
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static uint8_t SampleRecord_writeVarint(uint8_t *buffer, uint32_t value);
+static uint8_t SampleRecord_readVarint(const uint8_t *buffer, uint16_t length, uint32_t *value);
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+/**
+ * Reset delta state, must be called before the first record of each batch on
+ * both sides.
+ */
+void SampleRecord_initCoder(SampleRecord_Coder_t *coder)
+{
+  uint8_t sensorId;
+
+  coder->timestamp = 0;
+  for (sensorId = 0; sensorId < SAMPLERECORD_MAXSENSORS; sensorId++)
+  {
+    coder->value[sensorId] = 0;
+  }
+}
+
+/**
+ * Encode one record. The delta state is only updated if the record fits.
+ * @param coder delta state of the batch
+ * @param record sample to encode, must not be older than the previous one for
+ * a short time delta
+ * @param buffer destination
+ * @param size free space in buffer
+ * @return number of bytes written, 0 if record does not fit or sensor id is
+ * invalid
+ */
+uint8_t SampleRecord_encode(SampleRecord_Coder_t *coder, const SampleRecord_t *record, uint8_t *buffer, uint16_t size)
+{
+  uint8_t encoded[SAMPLERECORD_MAXENCODEDLENGTH];
+  uint8_t length = 1;
+  uint32_t delta;
+  uint8_t index;
+
+  if (record->sensorId >= SAMPLERECORD_MAXSENSORS) return 0;
+  encoded[0] = record->sensorId;
+  if (record->timestamp != coder->timestamp)
+  {
+    encoded[0] |= SAMPLERECORD_HEADER_TIME;
+    length += SampleRecord_writeVarint(&encoded[length], record->timestamp - coder->timestamp);
+  }
+  /* zigzag: small negative and positive deltas both get small codes */
+  delta = (uint32_t)record->value - (uint32_t)coder->value[record->sensorId];
+  delta = (delta << 1) ^ ((delta & 0x80000000UL) ? 0xffffffffUL : 0);
+  length += SampleRecord_writeVarint(&encoded[length], delta);
+  if (record->status)
+  {
+    encoded[0] |= SAMPLERECORD_HEADER_STATUS;
+    encoded[length++] = record->status;
+  }
+  if (length > size) return 0;
+  for (index = 0; index < length; index++)
+  {
+    buffer[index] = encoded[index];
+  }
+  coder->timestamp = record->timestamp;
+  coder->value[record->sensorId] = record->value;
+  return length;
+}
+
+/**
+ * Decode one record.
+ * @param coder delta state of the batch
+ * @param buffer encoded stream
+ * @param length remaining bytes in buffer
+ * @param record decoded sample
+ * @return number of bytes consumed, 0 if record is truncated or invalid
+ */
+uint8_t SampleRecord_decode(SampleRecord_Coder_t *coder, const uint8_t *buffer, uint16_t length, SampleRecord_t *record)
+{
+  uint8_t header;
+  uint8_t consumed = 1;
+  uint8_t varintLength;
+  uint32_t timeDelta = 0;
+  uint32_t valueDelta;
+
+  if (length == 0) return 0;
+  header = buffer[0];
+  if ((header & ~(SAMPLERECORD_HEADER_SENSORID | SAMPLERECORD_HEADER_STATUS | SAMPLERECORD_HEADER_TIME)) || ((header & SAMPLERECORD_HEADER_SENSORID) >= SAMPLERECORD_MAXSENSORS)) return 0;
+  if (header & SAMPLERECORD_HEADER_TIME)
+  {
+    varintLength = SampleRecord_readVarint(&buffer[consumed], length - consumed, &timeDelta);
+    if (varintLength == 0) return 0;
+    consumed += varintLength;
+  }
+  varintLength = SampleRecord_readVarint(&buffer[consumed], length - consumed, &valueDelta);
+  if (varintLength == 0) return 0;
+  consumed += varintLength;
+  record->status = 0;
+  if (header & SAMPLERECORD_HEADER_STATUS)
+  {
+    if (consumed >= length) return 0;
+    record->status = buffer[consumed++];
+  }
+  valueDelta = (valueDelta >> 1) ^ ((valueDelta & 0x01) ? 0xffffffffUL : 0);
+  record->sensorId = header & SAMPLERECORD_HEADER_SENSORID;
+  record->timestamp = coder->timestamp + timeDelta;
+  record->value = (sint32_t)((uint32_t)coder->value[record->sensorId] + valueDelta);
+  coder->timestamp = record->timestamp;
+  coder->value[record->sensorId] = record->value;
+  return consumed;
+}
+
+/**
+ * Initialize an empty store.
+ * @param store store instance
+ * @param records memory for size samples
+ * @param size number of samples
+ */
+void SampleRecord_initStore(SampleRecord_Store_t *store, SampleRecord_t *records, uint8_t size)
+{
+  store->records = records;
+  store->size = size;
+  store->first = 0;
+  store->count = 0;
+  store->droppedCounter = 0;
+}
+
+/**
+ * Add a sample, overwrites the oldest one if the store is full.
+ */
+void SampleRecord_append(SampleRecord_Store_t *store, const SampleRecord_t *record)
+{
+  uint16_t index = (uint16_t)store->first + store->count;
+
+  if (index >= store->size) index -= store->size;
+  store->records[index] = *record;
+  if (store->count < store->size)
+  {
+    store->count++;
+  }
+  else
+  {
+    if (++store->first >= store->size) store->first = 0;
+    if (store->droppedCounter != 0xffff) store->droppedCounter++;
+  }
+}
+
+/**
+ * Encode as many of the oldest samples as fit into one batch. Samples stay in
+ * the store until SampleRecord_consume is called, e.g. after the transmission
+ * was acknowledged.
+ * @param store store instance
+ * @param buffer destination
+ * @param size size of buffer
+ * @param numberOfRecords receives number of samples encoded
+ * @return length of batch in bytes
+ */
+uint16_t SampleRecord_encodeBatch(const SampleRecord_Store_t *store, uint8_t *buffer, uint16_t size, uint8_t *numberOfRecords)
+{
+  SampleRecord_Coder_t coder;
+  uint16_t length = 0;
+  uint16_t index = store->first;
+  uint8_t recordLength;
+  uint8_t count;
+
+  SampleRecord_initCoder(&coder);
+  for (count = 0; count < store->count; count++)
+  {
+    recordLength = SampleRecord_encode(&coder, &store->records[index], &buffer[length], size - length);
+    if (recordLength == 0) break;
+    length += recordLength;
+    if (++index >= store->size) index = 0;
+  }
+  *numberOfRecords = count;
+  return length;
+}
+
+/**
+ * Remove the oldest samples, e.g. after they were sent.
+ */
+void SampleRecord_consume(SampleRecord_Store_t *store, uint8_t numberOfRecords)
+{
+  uint16_t first;
+
+  if (numberOfRecords > store->count) numberOfRecords = store->count;
+  first = (uint16_t)store->first + numberOfRecords;
+  if (first >= store->size) first -= store->size;
+  store->first = (uint8_t)first;
+  store->count -= numberOfRecords;
+}
+
+/**
+ * @return number of bytes written, at most 5
+ */
+static uint8_t SampleRecord_writeVarint(uint8_t *buffer, uint32_t value)
+{
+  uint8_t length = 0;
+
+  while (value >= SAMPLERECORD_VARINTCONTINUE)
+  {
+    buffer[length++] = (uint8_t)value | SAMPLERECORD_VARINTCONTINUE;
+    value >>= 7;
+  }
+  buffer[length++] = (uint8_t)value;
+  return length;
+}
+
+/**
+ * @return number of bytes read, 0 if truncated or longer than 5 bytes
+ */
+static uint8_t SampleRecord_readVarint(const uint8_t *buffer, uint16_t length, uint32_t *value)
+{
+  uint8_t index = 0;
+  uint8_t shift = 0;
+
+  *value = 0;
+  while (index < length && index < 5)
+  {
+    *value |= (uint32_t)(buffer[index] & ~SAMPLERECORD_VARINTCONTINUE) << shift;
+    if (!(buffer[index++] & SAMPLERECORD_VARINTCONTINUE)) return index;
+    shift += 7;
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+/** @ingroup SampleRecord
+ * @{
+ */
+
+#ifndef SAMPLERECORD_H_
+#define SAMPLERECORD_H_
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+#if (!defined SAMPLERECORD_OK)
+#define SAMPLERECORD_OK        0
+#endif
+
+#if (!defined SAMPLERECORD_NOT_OK)
+#define SAMPLERECORD_NOT_OK    1
+#endif
+
+/**
+ * Number of sensor ids, each id is one measured quantity (e.g. DHT22
+ * temperature). Encoder and decoder keep the last value of every id.
+ */
+#if (!defined SAMPLERECORD_MAXSENSORS)
+#define SAMPLERECORD_MAXSENSORS                 8
+#endif
+#if (SAMPLERECORD_MAXSENSORS > 32)
+#error "SAMPLERECORD_MAXSENSORS must not exceed 32, sensor id has 5 bit"
+#endif
+
+/**
+ * Maximum length of one encoded record: header, time delta and value varint
+ * of up to 5 bytes each, status
+ */
+#define SAMPLERECORD_MAXENCODEDLENGTH           12
+
+/* Header byte of an encoded record */
+#define SAMPLERECORD_HEADER_SENSORID            0x1f
+#define SAMPLERECORD_HEADER_STATUS              0x20  /*!< status byte follows, status is 0 otherwise */
+#define SAMPLERECORD_HEADER_TIME                0x40  /*!< time delta follows, same timestamp as previous record otherwise */
+
+/*******************| Type definitions |*******************************/
+/**
+ * One sample. Value is fixed-point in the unit of the sensor id, e.g.
+ * 0.1Celsius for DHT22 temperature. Status holds DHT22State_t, PPD42NS
+ * snapshot flags or similar, 0 if the sample is fine.
+ */
+typedef struct
+{
+  uint32_t timestamp;                           /*!< application time base, e.g. s */
+  sint32_t value;
+  uint8_t sensorId;                             /*!< below SAMPLERECORD_MAXSENSORS */
+  uint8_t status;
+} SampleRecord_t;
+
+/**
+ * Delta state of encoder or decoder. Both sides must start from the same state,
+ * i.e. every batch starts after SampleRecord_initCoder.
+ */
+typedef struct
+{
+  uint32_t timestamp;
+  sint32_t value[SAMPLERECORD_MAXSENSORS];
+} SampleRecord_Coder_t;
+
+/**
+ * Ring buffer of samples waiting for transmission. When full, the oldest
+ * sample is overwritten.
+ */
+typedef struct
+{
+  SampleRecord_t *records;
+  uint8_t size;
+  uint8_t first;                                /*!< index of oldest sample */
+  uint8_t count;
+  uint16_t droppedCounter;                      /*!< samples overwritten before being sent */
+} SampleRecord_Store_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+void SampleRecord_initCoder(SampleRecord_Coder_t *coder);
+uint8_t SampleRecord_encode(SampleRecord_Coder_t *coder, const SampleRecord_t *record, uint8_t *buffer, uint16_t size);
+uint8_t SampleRecord_decode(SampleRecord_Coder_t *coder, const uint8_t *buffer, uint16_t length, SampleRecord_t *record);
+void SampleRecord_initStore(SampleRecord_Store_t *store, SampleRecord_t *records, uint8_t size);
+void SampleRecord_append(SampleRecord_Store_t *store, const SampleRecord_t *record);
+uint16_t SampleRecord_encodeBatch(const SampleRecord_Store_t *store, uint8_t *buffer, uint16_t size, uint8_t *numberOfRecords);
+void SampleRecord_consume(SampleRecord_Store_t *store, uint8_t numberOfRecords);
+
+#endif
+/** @}*/
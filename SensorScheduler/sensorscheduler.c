@@ -0,0 +1,243 @@
+/*******************| Inclusions |*************************************/
+#include "sensorscheduler.h"
+
+/**
+ * @brief Cooperative scheduler for several sensors of different type
+ * Each sensor is read every period ms through the non blocking driver
+ * interface SensorScheduler_Driver_t. SensorScheduler_run must be called
+ * periodically from the main loop, it starts read-outs which are due, polls
+ * running ones and returns finished ones one at a time. As no driver blocks,
+ * a slow sensor (e.g. a PPD42NS window) never delays the others. For each
+ * sensor the latency from being due until finished is recorded, read-outs
+ * exceeding the deadline are counted as missed. A read-out still running
+ * after twice its deadline is abandoned as error.
+ * Failed read-outs are retried after retryDelay, the delay doubles with each
+ * further failure up to the period. Every SENSORSCHEDULER_POWERCYCLEFAILURES
+ * failures in a row the sensor is power cycled if the board allows it: it is
+ * switched off, switched on again after powerOffTime and read after
+ * warmUpTime. Thus a sensor recovers without intervention and the health state
+ * tells whether it currently delivers values.
+ * All times are in ms of a free running 16 bit counter, periods, deadlines and
+ * power off times must stay below 32768ms. Longer warm-up times are waited in
+ * steps, longer deadlines are clamped by SensorScheduler_init.
+*/
+
+/*******************| Macros |*****************************************/
+/* twice the deadline must fit into 16 bit */
+#define SENSORSCHEDULER_MAXDEADLINE             0x7fff
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static void SensorScheduler_finish(SensorScheduler_Entry_t *entry, SensorSchedulerStatus_t status, uint16_t nowMs);
+static void SensorScheduler_wait(SensorScheduler_Entry_t *entry, uint16_t nowMs, uint16_t time);
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+/**
+ * Initialize scheduler, all sensors are due after their warm-up time, i.e.
+ * sensors are expected to be switched on right before. Drivers must already be
+ * initialized. Deadlines above SENSORSCHEDULER_MAXDEADLINE are clamped.
+ * @param scheduler scheduler instance
+ * @param entries sensors with driver, context, period and deadline set
+ * @param numberOfEntries number of entries
+ * @param nowMs current time in ms
+ */
+void SensorScheduler_init(SensorScheduler_t *scheduler, SensorScheduler_Entry_t *entries, uint8_t numberOfEntries, uint16_t nowMs)
+{
+  SensorScheduler_Entry_t *entry;
+  uint8_t index;
+
+  scheduler->entries = entries;
+  scheduler->numberOfEntries = numberOfEntries;
+  scheduler->next = 0;
+  for (index = 0; index < numberOfEntries; index++)
+  {
+    entry = &entries[index];
+    if (entry->deadline > SENSORSCHEDULER_MAXDEADLINE) entry->deadline = SENSORSCHEDULER_MAXDEADLINE;
+    entry->poweredOff = 0;
+    SensorScheduler_wait(entry, nowMs, entry->warmUpTime);
+    entry->running = 0;
+    entry->resultPending = 0;
+    entry->status = SensorSchedulerStatus_Busy;
+    entry->health = SensorSchedulerHealth_Ok;
+    entry->consecutiveFailures = 0;
+    entry->statistics.readCounter = 0;
+    entry->statistics.errorCounter = 0;
+    entry->statistics.missedDeadlines = 0;
+    entry->statistics.lastLatency = 0;
+    entry->statistics.maxLatency = 0;
+    entry->statistics.powerCycles = 0;
+  }
+}
+
+/**
+ * Run the scheduler, must be called periodically from the main loop.
+ * @param scheduler scheduler instance
+ * @param nowMs current time in ms
+ * @return sensor whose read-out finished (check status and fetch result with
+ * SensorScheduler_readResult) or NULL. If several finished, the others are
+ * returned by the following calls.
+ */
+SensorScheduler_Entry_t *SensorScheduler_run(SensorScheduler_t *scheduler, uint16_t nowMs)
+{
+  SensorScheduler_Entry_t *entry;
+  SensorSchedulerStatus_t status;
+  uint8_t index;
+
+  for (index = 0; index < scheduler->numberOfEntries; index++)
+  {
+    entry = &scheduler->entries[index];
+    if (entry->resultPending) continue;
+    if (entry->running)
+    {
+      status = entry->driver->poll(entry->context);
+      if (status != SensorSchedulerStatus_Busy)
+      {
+        SensorScheduler_finish(entry, status, nowMs);
+      }
+      else if ((uint16_t)(nowMs - entry->due) > (uint16_t)(2 * entry->deadline))
+      {
+        SensorScheduler_finish(entry, SensorSchedulerStatus_Error, nowMs);
+      }
+    }
+    else if ((sint16_t)(nowMs - entry->due) >= 0)
+    {
+      if (entry->waitRemaining)
+      {
+        /* continue from the end of the last step, not from a late call */
+        SensorScheduler_wait(entry, entry->due, entry->waitRemaining);
+      }
+      else if (entry->poweredOff)
+      {
+        /* second phase of a power cycle, the read-out follows after warm-up */
+        entry->poweredOff = 0;
+        entry->setPower(1);
+        SensorScheduler_wait(entry, nowMs, entry->warmUpTime);
+      }
+      else
+      {
+        entry->statistics.readCounter++;
+        entry->running = 1;
+        if (entry->driver->start(entry->context) == SensorSchedulerStatus_Error)
+        {
+          SensorScheduler_finish(entry, SensorSchedulerStatus_Error, nowMs);
+        }
+      }
+    }
+  }
+  /* hand out pending results round robin, thus every sensor gets its turn */
+  for (index = 0; index < scheduler->numberOfEntries; index++)
+  {
+    entry = &scheduler->entries[scheduler->next];
+    if (++scheduler->next >= scheduler->numberOfEntries) scheduler->next = 0;
+    if (entry->resultPending)
+    {
+      entry->resultPending = 0;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Time the main loop may sleep before SensorScheduler_run must be called again,
+ * e.g. in PM2 with the sleep timer as wake-up source. While a read-out is
+ * running the drivers wake the MCU by their interrupts (edge capture, ADC,
+ * Timer1), thus the main loop should sleep in PM0 until the next
+ * interrupt instead.
+ * @param scheduler scheduler instance
+ * @param nowMs current time in ms
+ * @return ms until the next read-out is due, 0 if a read-out is running,
+ * overdue or a result is pending
+ */
+uint16_t SensorScheduler_idleTime(const SensorScheduler_t *scheduler, uint16_t nowMs)
+{
+  const SensorScheduler_Entry_t *entry;
+  uint16_t idleTime = 0x7fff;
+  sint16_t remaining;
+  uint8_t index;
+
+  for (index = 0; index < scheduler->numberOfEntries; index++)
+  {
+    entry = &scheduler->entries[index];
+    if (entry->running || entry->resultPending) return 0;
+    remaining = (sint16_t)(entry->due - nowMs);
+    if (remaining <= 0) return 0;
+    if ((uint16_t)remaining < idleTime) idleTime = (uint16_t)remaining;
+  }
+  return idleTime;
+}
+
+/**
+ * Readout function for the values of the last finished read-out of a sensor.
+ * @param entry sensor returned by SensorScheduler_run
+ * @param values receives up to SENSORSCHEDULER_MAXVALUES values, unit and
+ * order depend on the driver
+ * @return number of values, 0 if last read-out failed
+ */
+uint8_t SensorScheduler_readResult(const SensorScheduler_Entry_t *entry, sint32_t *values)
+{
+  if (entry->status != SensorSchedulerStatus_Done) return 0;
+  return entry->driver->result(entry->context, values);
+}
+
+/**
+ * Record statistics of a finished read-out and schedule the next one. If the
+ * sensor fell behind by more than a period, due periods are skipped instead of
+ * starting read-outs back to back. After a failure the retry is scheduled with
+ * exponential backoff.
+ */
+static void SensorScheduler_finish(SensorScheduler_Entry_t *entry, SensorSchedulerStatus_t status, uint16_t nowMs)
+{
+  uint16_t latency = nowMs - entry->due;
+  uint16_t retryDelay = entry->retryDelay;
+  uint8_t failures;
+
+  entry->running = 0;
+  entry->resultPending = 1;
+  entry->status = status;
+  entry->statistics.lastLatency = latency;
+  if (latency > entry->statistics.maxLatency) entry->statistics.maxLatency = latency;
+  if (latency > entry->deadline) entry->statistics.missedDeadlines++;
+  if (status != SensorSchedulerStatus_Error)
+  {
+    entry->consecutiveFailures = 0;
+    entry->health = SensorSchedulerHealth_Ok;
+    entry->due += entry->period;
+    if ((sint16_t)(nowMs - entry->due) >= 0) entry->due = nowMs + entry->period;
+    return;
+  }
+  entry->statistics.errorCounter++;
+  if (entry->consecutiveFailures != 0xff) entry->consecutiveFailures++;
+  entry->health = (entry->consecutiveFailures >= SENSORSCHEDULER_FAILEDFAILURES) ? SensorSchedulerHealth_Failed : SensorSchedulerHealth_Degraded;
+  if (((entry->consecutiveFailures % SENSORSCHEDULER_POWERCYCLEFAILURES) == 0) && (entry->setPower != NULL))
+  {
+    /* first phase of a power cycle, switched on again by SensorScheduler_run */
+    entry->setPower(0);
+    entry->poweredOff = 1;
+    entry->statistics.powerCycles++;
+    SensorScheduler_wait(entry, nowMs, entry->powerOffTime);
+    return;
+  }
+  /* retryDelay * 2^(failures - 1), at most one period */
+  for (failures = entry->consecutiveFailures; (failures > 1) && (retryDelay < entry->period); failures--)
+  {
+    retryDelay <<= 1;
+  }
+  if ((retryDelay == 0) || (retryDelay > entry->period)) retryDelay = entry->period;
+  if (retryDelay < entry->driver->minRetryDelay) retryDelay = entry->driver->minRetryDelay;
+  entry->due = nowMs + retryDelay;
+}
+
+/**
+ * Let the entry wait, times beyond the range of due are split into steps
+ */
+static void SensorScheduler_wait(SensorScheduler_Entry_t *entry, uint16_t nowMs, uint16_t time)
+{
+  uint16_t step = (time > 0x7fff) ? 0x7fff : time;
+
+  entry->due = nowMs + step;
+  entry->waitRemaining = time - step;
+}
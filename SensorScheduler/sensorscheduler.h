@@ -0,0 +1,122 @@
+/** @ingroup SensorScheduler
+ * @{
+ */
+
+#ifndef SENSORSCHEDULER_H_
+#define SENSORSCHEDULER_H_
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+#if (!defined SENSORSCHEDULER_OK)
+#define SENSORSCHEDULER_OK        0
+#endif
+
+#if (!defined SENSORSCHEDULER_NOT_OK)
+#define SENSORSCHEDULER_NOT_OK    1
+#endif
+
+/**
+ * Maximum number of values a driver delivers per read-out
+ */
+#if (!defined SENSORSCHEDULER_MAXVALUES)
+#define SENSORSCHEDULER_MAXVALUES               4
+#endif
+
+/**
+ * Recovery: consecutive failed read-outs after which the sensor is power
+ * cycled (if possible) and after which its health is SensorSchedulerHealth_Failed
+ */
+#if (!defined SENSORSCHEDULER_POWERCYCLEFAILURES)
+#define SENSORSCHEDULER_POWERCYCLEFAILURES      3
+#endif
+#if (!defined SENSORSCHEDULER_FAILEDFAILURES)
+#define SENSORSCHEDULER_FAILEDFAILURES          6
+#endif
+
+/*******************| Type definitions |*******************************/
+typedef enum
+{
+   SensorSchedulerStatus_Busy,                  /*!< read-out still running */
+   SensorSchedulerStatus_Done,                  /*!< read-out finished, result can be fetched */
+   SensorSchedulerStatus_Error                  /*!< read-out failed or could not be started */
+} SensorSchedulerStatus_t;
+
+typedef enum
+{
+   SensorSchedulerHealth_Ok,                    /*!< last read-out succeeded */
+   SensorSchedulerHealth_Degraded,              /*!< read-outs failing, retried with backoff */
+   SensorSchedulerHealth_Failed                 /*!< SENSORSCHEDULER_FAILEDFAILURES read-outs in a row failed, still retried every period */
+} SensorSchedulerHealth_t;
+
+/**
+ * Common interface of all sensor drivers. None of the functions may block,
+ * context is handed through unchanged. See sensorscheduler_drivers.h for the
+ * DHT22, PPD42NS and GP2Y1050 adapters.
+ */
+typedef struct
+{
+  SensorSchedulerStatus_t (*start)(void *context);
+  SensorSchedulerStatus_t (*poll)(void *context);
+  /** copy values of last read-out, return number of values written */
+  uint8_t (*result)(void *context, sint32_t *values);
+  uint16_t minRetryDelay;                       /*!< shortest retry delay in ms the sensor allows, e.g. DHT22 minimum read interval */
+} SensorScheduler_Driver_t;
+
+/**
+ * Timing statistics of one sensor, times in ms
+ */
+typedef struct
+{
+  uint16_t readCounter;                         /*!< read-outs started */
+  uint16_t errorCounter;                        /*!< read-outs ending in SensorSchedulerStatus_Error */
+  uint16_t missedDeadlines;                     /*!< read-outs finished later than deadline after being due */
+  uint16_t lastLatency;                         /*!< time from due until finished of last read-out */
+  uint16_t maxLatency;
+  uint16_t powerCycles;                         /*!< recovery attempts by switching the sensor off and on again */
+} SensorScheduler_Statistics_t;
+
+/**
+ * One sensor managed by the scheduler. driver, context, period, deadline,
+ * retryDelay, setPower, powerOffTime and warmUpTime are set by the
+ * application, the rest by SensorScheduler_init.
+ */
+typedef struct
+{
+  const SensorScheduler_Driver_t *driver;
+  void *context;
+  uint16_t period;                              /*!< time between read-outs in ms, below 32768 */
+  uint16_t deadline;                            /*!< maximum time from due until finished in ms, below 32768 (clamped), read-outs running twice as long are abandoned */
+  uint16_t retryDelay;                          /*!< delay of first retry after a failure in ms, doubled per failure up to period, 0 to retry after period; at least the minRetryDelay of the driver */
+  void (*setPower)(uint8_t on);                 /*!< switch sensor supply, NULL if not possible */
+  uint16_t powerOffTime;                        /*!< time the sensor stays switched off for a power cycle in ms, below 32768 */
+  uint16_t warmUpTime;                          /*!< time from power on (also SensorScheduler_init) until the next read-out in ms, see sensorscheduler_drivers.h */
+  uint16_t due;                                 /*!< time the next or running read-out, power on or end of wait is due */
+  uint16_t waitRemaining;                       /*!< part of a wait beyond 32767ms still to wait after due */
+  uint8_t poweredOff;                           /*!< switched off for a power cycle, switched on when due */
+  uint8_t running;
+  uint8_t resultPending;                        /*!< finished read-out not yet returned by SensorScheduler_run */
+  SensorSchedulerStatus_t status;               /*!< status of last finished read-out */
+  SensorSchedulerHealth_t health;
+  uint8_t consecutiveFailures;
+  SensorScheduler_Statistics_t statistics;
+} SensorScheduler_Entry_t;
+
+typedef struct
+{
+  SensorScheduler_Entry_t *entries;
+  uint8_t numberOfEntries;
+  uint8_t next;                                 /*!< entry checked first for a pending result */
+} SensorScheduler_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+void SensorScheduler_init(SensorScheduler_t *scheduler, SensorScheduler_Entry_t *entries, uint8_t numberOfEntries, uint16_t nowMs);
+SensorScheduler_Entry_t *SensorScheduler_run(SensorScheduler_t *scheduler, uint16_t nowMs);
+uint16_t SensorScheduler_idleTime(const SensorScheduler_t *scheduler, uint16_t nowMs);
+uint8_t SensorScheduler_readResult(const SensorScheduler_Entry_t *entry, sint32_t *values);
+
+#endif
+/** @}*/
@@ -0,0 +1,171 @@
+/*******************| Inclusions |*************************************/
+#include "sensorscheduler_drivers.h"
+
+/**
+ * @brief Adapters of DHT22, PPD42NS and GP2Y1050 to SensorScheduler_Driver_t
+*/
+
+/*******************| Macros |*****************************************/
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static SensorSchedulerStatus_t SensorScheduler_dht22Start(void *context);
+static SensorSchedulerStatus_t SensorScheduler_dht22Poll(void *context);
+static uint8_t SensorScheduler_dht22Result(void *context, sint32_t *values);
+static SensorSchedulerStatus_t SensorScheduler_ppd42nsStart(void *context);
+static SensorSchedulerStatus_t SensorScheduler_ppd42nsPoll(void *context);
+static uint8_t SensorScheduler_ppd42nsResult(void *context, sint32_t *values);
+static SensorSchedulerStatus_t SensorScheduler_gp2y1050Start(void *context);
+static SensorSchedulerStatus_t SensorScheduler_gp2y1050Poll(void *context);
+static uint8_t SensorScheduler_gp2y1050Result(void *context, sint32_t *values);
+
+/*******************| Global variables |*******************************/
+const SensorScheduler_Driver_t SensorScheduler_dht22Driver = {
+  SensorScheduler_dht22Start,
+  SensorScheduler_dht22Poll,
+  SensorScheduler_dht22Result,
+  DHT22_MINREADINTERVAL
+};
+
+const SensorScheduler_Driver_t SensorScheduler_ppd42nsDriver = {
+  SensorScheduler_ppd42nsStart,
+  SensorScheduler_ppd42nsPoll,
+  SensorScheduler_ppd42nsResult,
+  0
+};
+
+const SensorScheduler_Driver_t SensorScheduler_gp2y1050Driver = {
+  SensorScheduler_gp2y1050Start,
+  SensorScheduler_gp2y1050Poll,
+  SensorScheduler_gp2y1050Result,
+  0
+};
+
+/*******************| Function definition |****************************/
+/**
+ * Start DHT22 read-out, also after a failed one. A read-out abandoned by the
+ * scheduler is still in progress and is aborted first, otherwise no new one
+ * would be started.
+ */
+static SensorSchedulerStatus_t SensorScheduler_dht22Start(void *context)
+{
+  SensorScheduler_Dht22_t *dht22 = (SensorScheduler_Dht22_t *)context;
+
+  DHT22_abortSensorRead(dht22->handle);
+  if (DHT22_startSensorRead(dht22->handle, dht22->readTimer()) != DHT22State_ReadInProgress) return SensorSchedulerStatus_Error;
+  return SensorSchedulerStatus_Busy;
+}
+
+static SensorSchedulerStatus_t SensorScheduler_dht22Poll(void *context)
+{
+  SensorScheduler_Dht22_t *dht22 = (SensorScheduler_Dht22_t *)context;
+
+  switch (DHT22_pollSensor(dht22->handle, dht22->readTimer()))
+  {
+    case DHT22State_ReadInProgress:
+      return SensorSchedulerStatus_Busy;
+    case DHT22State_ReadDone:
+      return SensorSchedulerStatus_Done;
+    default:
+      return SensorSchedulerStatus_Error;
+  }
+}
+
+static uint8_t SensorScheduler_dht22Result(void *context, sint32_t *values)
+{
+  SensorScheduler_Dht22_t *dht22 = (SensorScheduler_Dht22_t *)context;
+
+  values[0] = dht22->handle->value.values.Temperatur;
+  values[1] = dht22->handle->value.values.RelativeHumidity;
+  return 2;
+}
+
+/**
+ * PPD42NS measures continuously, a read-out just waits for the next window.
+ */
+static SensorSchedulerStatus_t SensorScheduler_ppd42nsStart(void *context)
+{
+  SensorScheduler_Ppd42ns_t *ppd42ns = (SensorScheduler_Ppd42ns_t *)context;
+  PPD42NS_Snapshot_t snapshot;
+
+  if (ppd42ns->sensor >= PPD42NS_NUMBEROFSENSORS) return SensorSchedulerStatus_Error;
+  PPD42NS_readSnapshot(&snapshot);
+  ppd42ns->windowId = snapshot.windowId;
+  return SensorSchedulerStatus_Busy;
+}
+
+/**
+ * Done with the next window, error if one of the sensor's channels is silent,
+ * i.e. the sensor is disconnected or not powered. Edge errors only disturb
+ * single pulses, they would fail every read-out while the bucket stays in the
+ * window and trigger power cycles of a working sensor. Thus only edge errors
+ * of the newest bucket are recorded in errorChannels.
+ */
+static SensorSchedulerStatus_t SensorScheduler_ppd42nsPoll(void *context)
+{
+  SensorScheduler_Ppd42ns_t *ppd42ns = (SensorScheduler_Ppd42ns_t *)context;
+  PPD42NS_Snapshot_t snapshot;
+  uint8_t firstChannel = (uint8_t)(ppd42ns->sensor * PPD42NS_CHANNELSPERSENSOR);
+  uint8_t channel;
+
+  PPD42NS_readSnapshot(&snapshot);
+  if (snapshot.windowId == ppd42ns->windowId) return SensorSchedulerStatus_Busy;
+  ppd42ns->errorChannels = 0;
+  for (channel = 0; channel < PPD42NS_CHANNELSPERSENSOR; channel++)
+  {
+    if (snapshot.pulseStatistics[firstChannel + channel].edgeErrors) ppd42ns->errorChannels |= (uint8_t)(1 << channel);
+  }
+  if ((snapshot.silentChannels >> firstChannel) & ((1 << PPD42NS_CHANNELSPERSENSOR) - 1)) return SensorSchedulerStatus_Error;
+  return SensorSchedulerStatus_Done;
+}
+
+static uint8_t SensorScheduler_ppd42nsResult(void *context, sint32_t *values)
+{
+  SensorScheduler_Ppd42ns_t *ppd42ns = (SensorScheduler_Ppd42ns_t *)context;
+  uint32_t concentration;
+
+  if (PPD42NS_readValue(ppd42ns->sensor, PPD42NS_CHANNEL_P1, &concentration) != PPD42NS_OK) return 0;
+  values[0] = (sint32_t)concentration;
+  if (PPD42NS_readValue(ppd42ns->sensor, PPD42NS_CHANNEL_P2, &concentration) != PPD42NS_OK) return 0;
+  values[1] = (sint32_t)concentration;
+  return 2;
+}
+
+/**
+ * Start GP2Y1050 burst, a burst abandoned by the scheduler (e.g. lost ADC
+ * interrupt) is stopped first.
+ */
+static SensorSchedulerStatus_t SensorScheduler_gp2y1050Start(void *context)
+{
+  GP2Y1050State_t state = GP2Y1050_poll();
+
+  (void)context;
+  if ((state != GP2Y1050State_ReadDone) && (state != GP2Y1050State_ReadErrorImplausible)) GP2Y1050_init();
+  if (GP2Y1050_startBurst(SENSORSCHEDULER_GP2Y1050SAMPLES) != GP2Y1050State_Sampling) return SensorSchedulerStatus_Error;
+  return SensorSchedulerStatus_Busy;
+}
+
+static SensorSchedulerStatus_t SensorScheduler_gp2y1050Poll(void *context)
+{
+  (void)context;
+  switch (GP2Y1050_poll())
+  {
+    case GP2Y1050State_ReadDone:
+      return SensorSchedulerStatus_Done;
+    case GP2Y1050State_ReadErrorImplausible:
+      return SensorSchedulerStatus_Error;
+    default:
+      return SensorSchedulerStatus_Busy;
+  }
+}
+
+static uint8_t SensorScheduler_gp2y1050Result(void *context, sint32_t *values)
+{
+  uint16_t density;
+
+  (void)context;
+  if (GP2Y1050_readDustDensity(&density) != GP2Y1050_OK) return 0;
+  values[0] = density;
+  return 1;
+}
@@ -0,0 +1,83 @@
+/** @ingroup SensorScheduler
+ * @{
+ */
+
+#ifndef SENSORSCHEDULER_DRIVERS_H_
+#define SENSORSCHEDULER_DRIVERS_H_
+
+/*******************| Inclusions |*************************************/
+#include "sensorscheduler.h"
+#include <dht22.h>
+#include <ppd42ns.h>
+#include <gp2y1050.h>
+
+/*******************| Macros |*****************************************/
+/**
+ * Samples per GP2Y1050 burst started by the scheduler
+ */
+#if (!defined SENSORSCHEDULER_GP2Y1050SAMPLES)
+#define SENSORSCHEDULER_GP2Y1050SAMPLES         GP2Y1050_MAXSAMPLES
+#endif
+
+/**
+ * Warm-up times in ms for SensorScheduler_Entry_t.warmUpTime: the DHT22 does
+ * not answer within 1s after power on, the PPD42NS heater needs about a
+ * minute until the air flow and thus the pulses are stable. The GP2Y1050 is
+ * ready right away.
+ */
+#if (!defined SENSORSCHEDULER_DHT22WARMUPTIME)
+#define SENSORSCHEDULER_DHT22WARMUPTIME         2000
+#endif
+#if (!defined SENSORSCHEDULER_PPD42NSWARMUPTIME)
+#define SENSORSCHEDULER_PPD42NSWARMUPTIME       60000U
+#endif
+#if (!defined SENSORSCHEDULER_GP2Y1050WARMUPTIME)
+#define SENSORSCHEDULER_GP2Y1050WARMUPTIME      0
+#endif
+
+/**
+ * Time in ms a sensor supply stays off for a power cycle, long enough to
+ * discharge the decoupling capacitors of the sensor
+ */
+#if (!defined SENSORSCHEDULER_POWEROFFTIME)
+#define SENSORSCHEDULER_POWEROFFTIME            1000
+#endif
+
+/*******************| Type definitions |*******************************/
+/**
+ * Context of a DHT22 entry. Values: temperature in 0.1Celsius, relative
+ * humidity in 0.1%RH. Period must be at least DHT22_MINREADINTERVAL, retries
+ * are delayed at least as long.
+ */
+typedef struct
+{
+  DHT22_Handle_t *handle;                       /*!< initialized with DHT22_initSensor */
+  uint16_t (*readTimer)(void);                  /*!< timer feeding DHT22_sensorEdgeCallback */
+} SensorScheduler_Dht22_t;
+
+/**
+ * Context of a PPD42NS entry, one entry per sensor. Finishes with the next
+ * published window, thus the period should be the bucket length. Values: P1
+ * and P2 concentration in particle/m^3. Only a silent channel fails the
+ * read-out, edge errors are a quality flag of the values.
+ */
+typedef struct
+{
+  uint8_t sensor;                               /*!< sensor number starting with 0 */
+  uint16_t windowId;                            /*!< window published before start */
+  uint8_t errorChannels;                        /*!< bit PPD42NS_CHANNEL_Px set if Px had edge errors in the newest bucket of the last window, values may be inaccurate */
+} SensorScheduler_Ppd42ns_t;
+
+/*******************| Global variables |*******************************/
+/**
+ * Drivers for SensorScheduler_Entry_t. GP2Y1050 needs no context (NULL),
+ * value: dust density in ug/m^3.
+ */
+extern const SensorScheduler_Driver_t SensorScheduler_dht22Driver;
+extern const SensorScheduler_Driver_t SensorScheduler_ppd42nsDriver;
+extern const SensorScheduler_Driver_t SensorScheduler_gp2y1050Driver;
+
+/*******************| Function prototypes |****************************/
+
+#endif
+/** @}*/
@@ -0,0 +1,156 @@
+/*******************| Inclusions |*************************************/
+#include "streamfilter.h"
+
+/**
+ * @brief Streaming statistics and change detection for sensor channels
+ * Every new value of a channel (DHT22 temperature, PPD42NS ratio, GP2Y1050
+ * density, ...) is passed to StreamFilter_update, only if it returns a report
+ * reason the value needs to be sent. Criteria are
+ * - deadband: value differs from the last reported one by at least deadband
+ * - CUSUM: deviations from the last reported value beyond the drift are summed
+ *   up separately for both directions, a small but persistent change is
+ *   reported once the sum exceeds the threshold
+ * - heartbeat: nothing was reported for heartbeat time units
+ * Per channel RAM is constant, mean and variance are exponential moving
+ * averages. No division is used, thus it is cheap on the 8051 and gives the
+ * same results on the host for tuning thresholds with recorded data.
+ * The Q8 mean needs values within +-2^22, larger ones are scaled down by
+ * valueShift for mean and variance. Values beyond the limits are clamped and
+ * counted, see STREAMFILTER_MAXVALUE.
+*/
+
+/*******************| Macros |*****************************************/
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static void StreamFilter_report(StreamFilter_Channel_t *channel, sint32_t value, uint16_t now);
+static sint32_t StreamFilter_clamp(sint32_t value, sint32_t limit, uint8_t *clamped);
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+/**
+ * Initialize channel, the next value will be reported.
+ * @param channel channel instance
+ * @param config change detection, must stay valid
+ */
+void StreamFilter_init(StreamFilter_Channel_t *channel, const StreamFilter_Config_t *config)
+{
+  channel->config = config;
+  channel->started = 0;
+  channel->statistics.mean = 0;
+  channel->statistics.variance = 0;
+  StreamFilter_resetStatistics(channel);
+}
+
+/**
+ * Add a value to the statistics and decide whether it must be reported.
+ * @param channel channel instance
+ * @param value new value
+ * @param now current time, same unit as heartbeat
+ * @return STREAMFILTER_REPORT_xxx flags, STREAMFILTER_REPORT_NONE if value is
+ * redundant
+ */
+uint8_t StreamFilter_update(StreamFilter_Channel_t *channel, sint32_t value, uint16_t now)
+{
+  const StreamFilter_Config_t *config = channel->config;
+  StreamFilter_Statistics_t *statistics = &channel->statistics;
+  uint8_t reason = STREAMFILTER_REPORT_NONE;
+  uint8_t clamped = 0;
+  sint32_t scaled;
+  sint32_t deviation;
+  uint32_t magnitude;
+
+  value = StreamFilter_clamp(value, STREAMFILTER_MAXVALUE, &clamped);
+  scaled = StreamFilter_clamp(value >> config->valueShift, STREAMFILTER_MAXSCALEDVALUE, &clamped);
+  if (clamped && (statistics->outOfRange != 0xffff)) statistics->outOfRange++;
+  if (!channel->started)
+  {
+    channel->started = 1;
+    statistics->mean = scaled * 256;
+    StreamFilter_report(channel, value, now);
+    statistics->count = 1;
+    statistics->minimum = value;
+    statistics->maximum = value;
+    return STREAMFILTER_REPORT_FIRST;
+  }
+
+  /* statistics */
+  if (statistics->count != 0xffff) statistics->count++;
+  if (statistics->count == 1) statistics->minimum = statistics->maximum = value;
+  if (value < statistics->minimum) statistics->minimum = value;
+  if (value > statistics->maximum) statistics->maximum = value;
+  /* deviation from mean in Q8, its square is taken in Q4 to stay within 32 bit */
+  deviation = scaled * 256 - statistics->mean;
+  statistics->mean += deviation >> config->averageShift;
+  magnitude = ((deviation < 0) ? (uint32_t)-deviation : (uint32_t)deviation) >> 4;
+  if (magnitude > 0xffff) magnitude = 0xffff;
+  statistics->variance += ((magnitude * magnitude) >> config->averageShift) - (statistics->variance >> config->averageShift);
+
+  /* change detection relative to the last reported value */
+  deviation = value - channel->reported;
+  magnitude = (deviation < 0) ? (uint32_t)-deviation : (uint32_t)deviation;
+  if (config->deadband && (magnitude >= config->deadband)) reason |= STREAMFILTER_REPORT_DEADBAND;
+  if (config->cusumThreshold)
+  {
+    channel->cusumHigh += deviation - (sint32_t)config->cusumDrift;
+    if (channel->cusumHigh < 0) channel->cusumHigh = 0;
+    channel->cusumLow -= deviation + (sint32_t)config->cusumDrift;
+    if (channel->cusumLow < 0) channel->cusumLow = 0;
+    if (((uint32_t)channel->cusumHigh > config->cusumThreshold) || ((uint32_t)channel->cusumLow > config->cusumThreshold)) reason |= STREAMFILTER_REPORT_CUSUM;
+  }
+  if (config->heartbeat && ((uint16_t)(now - channel->reportTime) >= config->heartbeat)) reason |= STREAMFILTER_REPORT_HEARTBEAT;
+  if (reason != STREAMFILTER_REPORT_NONE) StreamFilter_report(channel, value, now);
+  return reason;
+}
+
+/**
+ * Get a copy of the statistics, e.g. to send them along with a report.
+ */
+void StreamFilter_readStatistics(const StreamFilter_Channel_t *channel, StreamFilter_Statistics_t *statistics)
+{
+  *statistics = channel->statistics;
+}
+
+/**
+ * Restart minimum, maximum, count and outOfRange, e.g. after they were sent.
+ * Mean and variance are kept.
+ */
+void StreamFilter_resetStatistics(StreamFilter_Channel_t *channel)
+{
+  channel->statistics.count = 0;
+  channel->statistics.outOfRange = 0;
+  channel->statistics.minimum = 0;
+  channel->statistics.maximum = 0;
+}
+
+/**
+ * Make value the new reference for change detection.
+ */
+static void StreamFilter_report(StreamFilter_Channel_t *channel, sint32_t value, uint16_t now)
+{
+  channel->reported = value;
+  channel->reportTime = now;
+  channel->cusumHigh = 0;
+  channel->cusumLow = 0;
+}
+
+/**
+ * Limit value to +-limit.
+ * @param clamped set to 1 if value was out of range
+ */
+static sint32_t StreamFilter_clamp(sint32_t value, sint32_t limit, uint8_t *clamped)
+{
+  if (value > limit)
+  {
+    *clamped = 1;
+    return limit;
+  }
+  if (value < -limit)
+  {
+    *clamped = 1;
+    return -limit;
+  }
+  return value;
+}
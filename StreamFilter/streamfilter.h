@@ -0,0 +1,77 @@
+/** @ingroup StreamFilter
+ * @{
+ */
+
+#ifndef STREAMFILTER_H_
+#define STREAMFILTER_H_
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+/* Reasons to report a sample, returned by StreamFilter_update */
+#define STREAMFILTER_REPORT_NONE                0x00  /*!< sample is redundant */
+#define STREAMFILTER_REPORT_FIRST               0x01  /*!< first sample of the channel */
+#define STREAMFILTER_REPORT_DEADBAND            0x02  /*!< sample left the deadband around the last reported one */
+#define STREAMFILTER_REPORT_CUSUM               0x04  /*!< cumulative deviation exceeded the threshold */
+#define STREAMFILTER_REPORT_HEARTBEAT           0x08  /*!< nothing reported for heartbeat time */
+
+/**
+ * Values are clamped to +-STREAMFILTER_MAXVALUE, thus differences and CUSUM
+ * sums stay within 32 bit. Mean and variance are taken of value >> valueShift
+ * in Q8, which is clamped to +-STREAMFILTER_MAXSCALEDVALUE.
+ */
+#define STREAMFILTER_MAXVALUE                   0x1fffffffL
+#define STREAMFILTER_MAXSCALEDVALUE             0x003fffffL
+
+/*******************| Type definitions |*******************************/
+/**
+ * Change detection of one channel, can be shared by channels of the same kind.
+ * A criterion is disabled by setting its threshold to 0.
+ */
+typedef struct
+{
+  uint32_t deadband;                            /*!< report if |value - reported| >= deadband */
+  uint32_t cusumDrift;                          /*!< deviation tolerated per sample (noise level), below 2^30 */
+  uint32_t cusumThreshold;                      /*!< report if summed deviation beyond drift exceeds threshold, below 2^30 */
+  uint16_t heartbeat;                           /*!< report at least every heartbeat time units, below 32768 */
+  uint8_t averageShift;                         /*!< mean and variance average over ~2^averageShift samples */
+  uint8_t valueShift;                           /*!< mean and variance are taken of value >> valueShift, which should stay within +-2^22, e.g. 4 for PPD42NS_readValue */
+} StreamFilter_Config_t;
+
+/**
+ * Statistics of one channel. Mean and variance are exponential moving
+ * averages, minimum, maximum and count are collected since
+ * StreamFilter_resetStatistics.
+ */
+typedef struct
+{
+  sint32_t mean;                                /*!< Q8 of value >> valueShift */
+  uint32_t variance;                            /*!< Q8 of value >> valueShift, deviations beyond 4095 are clipped */
+  sint32_t minimum;
+  sint32_t maximum;
+  uint16_t count;                               /*!< saturates at 0xffff */
+  uint16_t outOfRange;                          /*!< values clamped, see STREAMFILTER_MAXVALUE, saturates at 0xffff */
+} StreamFilter_Statistics_t;
+
+typedef struct
+{
+  const StreamFilter_Config_t *config;
+  StreamFilter_Statistics_t statistics;
+  sint32_t reported;                            /*!< last reported value */
+  sint32_t cusumHigh;                           /*!< summed deviation above reported value */
+  sint32_t cusumLow;                            /*!< summed deviation below reported value */
+  uint16_t reportTime;                          /*!< time of last report */
+  uint8_t started;
+} StreamFilter_Channel_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+void StreamFilter_init(StreamFilter_Channel_t *channel, const StreamFilter_Config_t *config);
+uint8_t StreamFilter_update(StreamFilter_Channel_t *channel, sint32_t value, uint16_t now);
+void StreamFilter_readStatistics(const StreamFilter_Channel_t *channel, StreamFilter_Statistics_t *statistics);
+void StreamFilter_resetStatistics(StreamFilter_Channel_t *channel);
+
+#endif
+/** @}*/
@@ -0,0 +1,34 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+/**
+ * Minimal check macros of the host tests. A failed check is printed and
+ * counted, the test executable returns TEST_RESULT() from main.
+ */
+
+/*******************| Inclusions |*************************************/
+#include <stdio.h>
+
+/*******************| Macros |*****************************************/
+#define TEST_ASSERT(condition) \
+  do { if (!(condition)) { Test_failures++; printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); } } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) \
+  do { long long test_expected = (long long)(expected); long long test_actual = (long long)(actual); \
+    if (test_expected != test_actual) { Test_failures++; printf("%s:%d: %s: expected %lld, got %lld\n", __FILE__, __LINE__, #actual, test_expected, test_actual); } } while (0)
+
+#define TEST_ASSERT_WITHIN(delta, expected, actual) \
+  do { long long test_expected = (long long)(expected); long long test_actual = (long long)(actual); \
+    if ((test_actual < test_expected - (long long)(delta)) || (test_actual > test_expected + (long long)(delta))) { Test_failures++; \
+      printf("%s:%d: %s: expected %lld +- %lld, got %lld\n", __FILE__, __LINE__, #actual, test_expected, (long long)(delta), test_actual); } } while (0)
+
+#define TEST_RUN(test) \
+  do { printf("%s\n", #test); test(); } while (0)
+
+#define TEST_RESULT() \
+  (Test_failures ? (printf("%u check(s) failed\n", Test_failures), 1) : 0)
+
+/*******************| Global variables |*******************************/
+static unsigned int Test_failures;
+
+#endif
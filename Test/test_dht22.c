@@ -0,0 +1,404 @@
+/*******************| Inclusions |*************************************/
+#include "test.h"
+#include "dht22_hal_host.h"
+
+/**
+ * @brief Host tests of the DHT22 module on simulated lines
+*/
+
+/*******************| Global variables |*******************************/
+static uint32_t toggles[DHT22_HOSTMAXTOGGLES];
+
+/**
+ * Falling edges of one frame recorded from a sensor in us after the release
+ * of the data line: 58.4%RH, 22.7Celsius, bit periods vary by +-3us
+ */
+static const uint16_t recordedEdges[DHT22_NUMBEROFEDGESFROMSENSOR] = {
+  31, 193, 269, 344, 421, 500, 574, 648, 771, 849, 923, 1042, 1120, 1194,
+  1315, 1390, 1464, 1538, 1615, 1692, 1766, 1841, 1915, 1993, 2070, 2144, 2267,
+  2388, 2505, 2580, 2659, 2738, 2859, 2976, 3054, 3132, 3252, 3326, 3444,
+  3561, 3639, 3762
+};
+
+/*******************| Function definition |****************************/
+/**
+ * Check the decoded sensor values and the CRC received
+ */
+static void expectFrame(const DHT22_SensorValue_t *value, uint16_t relativeHumidity, sint16_t temperature)
+{
+  uint16_t magnitude = (uint16_t)((temperature < 0) ? -temperature : temperature);
+  uint8_t temperatureHigh = (uint8_t)(magnitude >> 8) | (uint8_t)((temperature < 0) ? 0x80 : 0);
+
+  TEST_ASSERT_EQUAL(relativeHumidity, value->values.RelativeHumidity);
+  TEST_ASSERT_EQUAL(temperature, value->values.Temperatur);
+  TEST_ASSERT_EQUAL((uint8_t)((relativeHumidity >> 8) + relativeHumidity + temperatureHigh + magnitude), value->values.CRC);
+}
+
+/**
+ * Store the pulse widths of a frame for DHT22_decodeFrames, 20 for a zero and
+ * 50 for a one
+ */
+static void encodeWidths(uint16_t relativeHumidity, sint16_t temperature, uint8_t *width)
+{
+  uint8_t frame[DHT22_NUMBEROFBITSFROMSENSOR / 8];
+  uint16_t magnitude = (uint16_t)((temperature < 0) ? -temperature : temperature);
+  uint8_t bit;
+
+  frame[0] = (uint8_t)(relativeHumidity >> 8);
+  frame[1] = (uint8_t)relativeHumidity;
+  frame[2] = (uint8_t)((magnitude >> 8) & 0x7f) | (uint8_t)((temperature < 0) ? 0x80 : 0);
+  frame[3] = (uint8_t)magnitude;
+  frame[4] = (uint8_t)(frame[0] + frame[1] + frame[2] + frame[3]);
+  for (bit = 0; bit < DHT22_NUMBEROFBITSFROMSENSOR; bit++)
+  {
+    width[bit] = (frame[bit / 8] & (0x80 >> (bit % 8))) ? 50 : 20;
+  }
+}
+
+/**
+ * Let the asynchronous read-out run until it finished
+ */
+static DHT22State_t runRead(DHT22_Handle_t *handle)
+{
+  DHT22State_t state = DHT22_startSensorRead(handle, DHT22_hostReadTimer());
+
+  while (state == DHT22State_ReadInProgress)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + 100);
+    state = DHT22_pollSensor(handle, DHT22_hostReadTimer());
+  }
+  return state;
+}
+
+static void test_blockingRead(void)
+{
+  DHT22_hostInit();
+  DHT22_hostSetResponse(0, toggles, DHT22_hostEncodeFrame(652, 231, toggles));
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_Init, DHT22_readValues());
+  expectFrame(&DHT22_SensorValue, 652, 231);
+  /* a frame takes about 5ms */
+  TEST_ASSERT(DHT22_hostTime < DHT22_MCUSendStartSignalTime + 6000);
+}
+
+static void test_blockingStuckAtVCC(void)
+{
+  DHT22_hostInit();
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorStuckAtVCC, DHT22_readValues());
+}
+
+static void test_blockingStuckAtGND(void)
+{
+  DHT22_hostInit();
+  toggles[0] = 0;
+  DHT22_hostSetResponse(0, toggles, 1);
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorStuckAtGND, DHT22_readValues());
+}
+
+static void test_blockingTimeout(void)
+{
+  /* sensor stops in the middle of the frame */
+  DHT22_hostInit();
+  DHT22_hostEncodeFrame(652, 231, toggles);
+  DHT22_hostSetResponse(0, toggles, DHT22_HOSTFRAMETOGGLES / 2);
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorTimeout, DHT22_readValues());
+  /* and recovers with the next read-out */
+  DHT22_hostSetResponse(0, toggles, DHT22_HOSTFRAMETOGGLES);
+  TEST_ASSERT_EQUAL(DHT22State_Init, DHT22_readValues());
+}
+
+static void test_asyncRead(void)
+{
+  DHT22_Handle_t handle = { 0 };
+
+  DHT22_hostInit();
+  DHT22_hostSetResponse(1, toggles, DHT22_hostEncodeFrame(1000, 0x123, toggles));
+  DHT22_initSensor(&handle, &DHT22_hostPin[1]);
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, runRead(&handle));
+  expectFrame(&handle.value, 1000, 0x123);
+  TEST_ASSERT_EQUAL(1, handle.statistics.readCounter);
+  TEST_ASSERT_EQUAL(0, handle.statistics.failedReadCounter);
+}
+
+static void test_asyncRecordedTrace(void)
+{
+  /* timer wraps during the frame */
+  uint16_t start = 0xf000;
+  uint16_t release = (uint16_t)(start + DHT22_MCUSendStartSignalTime);
+  uint8_t edge;
+
+  DHT22_hostInit();
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_startRead(start));
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_poll((uint16_t)(release - 1)));
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_poll(release));
+  for (edge = 0; edge < DHT22_NUMBEROFEDGESFROMSENSOR; edge++)
+  {
+    DHT22_edgeCallback((uint16_t)(release + recordedEdges[edge]));
+    if (edge < DHT22_NUMBEROFEDGESFROMSENSOR - 1) TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_poll((uint16_t)(release + recordedEdges[edge])));
+  }
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, DHT22_poll((uint16_t)(release + 4000)));
+  expectFrame(&DHT22_SensorValue, 584, 227);
+}
+
+/**
+ * Release the data line of an asynchronous read-out, replay the recorded frame
+ * and let the read-out finish
+ */
+static DHT22State_t replayRead(DHT22_Handle_t *handle, const Trace_Distortion_t *distortion)
+{
+  Trace_Event_t trace[DHT22_NUMBEROFEDGESFROMSENSOR];
+  DHT22State_t state;
+  uint8_t edge;
+
+  for (edge = 0; edge < DHT22_NUMBEROFEDGESFROMSENSOR; edge++)
+  {
+    trace[edge].timestamp = recordedEdges[edge];
+    trace[edge].channel = 3;
+    trace[edge].level = 0;
+  }
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_startSensorRead(handle, DHT22_hostReadTimer()));
+  DHT22_hostRunUntil(DHT22_hostTime + DHT22_MCUSendStartSignalTime);
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, DHT22_pollSensor(handle, DHT22_hostReadTimer()));
+  DHT22_hostReplay(handle, trace, DHT22_NUMBEROFEDGESFROMSENSOR, 3, distortion);
+  do
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + 100);
+    state = DHT22_pollSensor(handle, DHT22_hostReadTimer());
+  } while (state == DHT22State_ReadInProgress);
+  return state;
+}
+
+static void test_asyncReplay(void)
+{
+  DHT22_Handle_t handle = { 0 };
+  Trace_Distortion_t distortion = { 0, 0, 0 };
+  uint8_t read;
+
+  DHT22_hostInit();
+  DHT22_initSensor(&handle, &DHT22_hostPin[3]);
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, replayRead(&handle, NULL));
+  expectFrame(&handle.value, 584, 227);
+  /* constant latency, jitter and a timer 2% off are within the tolerance of
+   * the bit threshold */
+  distortion.skewPpm = 20000;
+  distortion.jitter = 8;
+  distortion.latency = 30;
+  for (read = 0; read < 20; read++)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + DHT22_MINREADINTERVAL * 1000UL);
+    TEST_ASSERT_EQUAL(DHT22State_ReadDone, replayRead(&handle, &distortion));
+    expectFrame(&handle.value, 584, 227);
+  }
+  /* jitter beyond the difference of zero and one bits corrupts frames */
+  distortion.jitter = 60;
+  DHT22_hostRunUntil(DHT22_hostTime + DHT22_MINREADINTERVAL * 1000UL);
+  TEST_ASSERT(replayRead(&handle, &distortion) != DHT22State_ReadDone);
+}
+
+static void test_asyncNoResponse(void)
+{
+  DHT22_Handle_t handle = { 0 };
+
+  DHT22_hostInit();
+  DHT22_initSensor(&handle, &DHT22_hostPin[0]);
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorStuckAtVCC, runRead(&handle));
+  /* reported once the read timeout expired, not earlier */
+  TEST_ASSERT(DHT22_hostTime >= DHT22_MCUSendStartSignalTime + DHT22_READTIMEOUT / DHT22_TIMERTICKSPERUS);
+  TEST_ASSERT(DHT22_hostTime <= DHT22_MCUSendStartSignalTime + DHT22_READTIMEOUT / DHT22_TIMERTICKSPERUS + 200);
+  toggles[0] = 0;
+  DHT22_hostSetResponse(0, toggles, 1);
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorStuckAtGND, runRead(&handle));
+  TEST_ASSERT_EQUAL(1, handle.statistics.stuckAtVCCCounter);
+  TEST_ASSERT_EQUAL(1, handle.statistics.stuckAtGNDCounter);
+}
+
+static void test_asyncTimeout(void)
+{
+  DHT22_Handle_t handle = { 0 };
+
+  DHT22_hostInit();
+  DHT22_hostEncodeFrame(652, 231, toggles);
+  DHT22_hostSetResponse(2, toggles, DHT22_HOSTFRAMETOGGLES / 2);
+  DHT22_initSensor(&handle, &DHT22_hostPin[2]);
+  TEST_ASSERT_EQUAL(DHT22State_ReadErrorTimeout, runRead(&handle));
+  TEST_ASSERT_EQUAL(1, handle.statistics.timeoutCounter);
+  /* the next read-out is allowed right away and succeeds */
+  DHT22_hostSetResponse(2, toggles, DHT22_HOSTFRAMETOGGLES);
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, runRead(&handle));
+  expectFrame(&handle.value, 652, 231);
+  TEST_ASSERT_EQUAL(1, handle.statistics.retryCounter);
+  TEST_ASSERT(handle.statistics.maxFrameTime < 5000 * DHT22_TIMERTICKSPERUS);
+}
+
+static void test_negativeTemperature(void)
+{
+  DHT22_Handle_t handle = { 0 };
+
+  DHT22_hostInit();
+  DHT22_hostSetResponse(0, toggles, DHT22_hostEncodeFrame(998, -105, toggles));
+  DHT22_init();
+  TEST_ASSERT_EQUAL(DHT22State_Init, DHT22_readValues());
+  expectFrame(&DHT22_SensorValue, 998, -105);
+  /* sign bit only, magnitude above one byte */
+  DHT22_hostSetResponse(3, toggles, DHT22_hostEncodeFrame(0x1ff, -400, toggles));
+  DHT22_initSensor(&handle, &DHT22_hostPin[3]);
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, runRead(&handle));
+  expectFrame(&handle.value, 0x1ff, -400);
+}
+
+static void test_decodeFrames(void)
+{
+  static const sint16_t temperature[4] = { 0, 1, -1, 800 };
+  uint8_t width[4 * DHT22_NUMBEROFBITSFROMSENSOR];
+  DHT22_SensorValue_t values[4];
+  uint8_t frame;
+
+  for (frame = 0; frame < 4; frame++)
+  {
+    encodeWidths((uint16_t)(frame * 250), temperature[frame], &width[frame * DHT22_NUMBEROFBITSFROMSENSOR]);
+  }
+  /* flip the last bit of the CRC of the third frame */
+  width[3 * DHT22_NUMBEROFBITSFROMSENSOR - 1] ^= 20 ^ 50;
+  TEST_ASSERT_EQUAL(3, DHT22_decodeFrames(width, 35, values, 4));
+  expectFrame(&values[0], 0, 0);
+  expectFrame(&values[1], 250, 1);
+  TEST_ASSERT_EQUAL(DHT22_RelativeHumidityInvalidValue, values[2].values.RelativeHumidity);
+  TEST_ASSERT_EQUAL((sint16_t)DHT22_TemperaturInvalidValue, values[2].values.Temperatur);
+  expectFrame(&values[3], 750, 800);
+}
+
+static void test_calibration(void)
+{
+  DHT22_Handle_t handle = { 0 };
+  uint8_t read;
+
+  DHT22_hostInit();
+  DHT22_hostSetResponse(0, toggles, DHT22_hostEncodeFrame(652, 231, toggles));
+  DHT22_initSensor(&handle, &DHT22_hostPin[0]);
+  /* asynchronous bit periods are 76 and 120 ticks, split at 98 */
+  DHT22_setCalibration(&handle, DHT22Mode_Asynchronous, 90 * DHT22_TIMERTICKSPERUS, 1);
+  for (read = 0; read < 8; read++)
+  {
+    TEST_ASSERT_EQUAL(DHT22State_ReadDone, runRead(&handle));
+  }
+  /* a step truncated towards the frame threshold would stop 3 counts short */
+  TEST_ASSERT_WITHIN(1, 98 * DHT22_TIMERTICKSPERUS, DHT22_getCalibration(&handle, DHT22Mode_Asynchronous));
+  TEST_ASSERT_EQUAL(0, DHT22_getCalibration(&handle, DHT22Mode_Blocking));
+  /* blocking read-outs on the same sensor learn their own threshold from
+   * loop counts and leave the asynchronous one alone */
+  for (read = 0; read < 8; read++)
+  {
+    TEST_ASSERT_EQUAL(DHT22State_Init, DHT22_readSensor(&handle));
+    expectFrame(&handle.value, 652, 231);
+  }
+  TEST_ASSERT_WITHIN(1, 98 * DHT22_TIMERTICKSPERUS, DHT22_getCalibration(&handle, DHT22Mode_Asynchronous));
+  TEST_ASSERT_WITHIN(3, DHT22_MCUWaitForSensorSendZero, DHT22_getCalibration(&handle, DHT22Mode_Blocking));
+  TEST_ASSERT_EQUAL(DHT22State_ReadDone, runRead(&handle));
+  expectFrame(&handle.value, 652, 231);
+  TEST_ASSERT_EQUAL(0, handle.statistics.failedReadCounter);
+}
+
+/**
+ * Run the scheduler in steps of 1ms from startMs until endMs. Read-out starts
+ * of each sensor must be DHT22_MINREADINTERVAL apart, those of different
+ * sensors at least one slot.
+ * @return number of read-outs started
+ */
+static uint16_t runScheduler(DHT22_Scheduler_t *scheduler, uint32_t startMs, uint32_t endMs, uint32_t *lastStartMs)
+{
+  static uint32_t lastAnyStartMs;
+  DHT22_Handle_t *handle;
+  uint16_t readCounter;
+  uint16_t starts = 0;
+  uint32_t ms;
+  uint8_t sensor;
+
+  if (startMs == 0) lastAnyStartMs = 0xffffffffUL;
+  for (ms = startMs; ms < endMs; ms++)
+  {
+    DHT22_hostRunUntil(ms * 1000);
+    handle = &scheduler->sensors[scheduler->current == scheduler->numberOfSensors - 1 ? 0 : scheduler->current + 1];
+    readCounter = handle->statistics.readCounter;
+    DHT22_runScheduler(scheduler, DHT22_hostReadTimer(), (uint16_t)ms);
+    if (handle->statistics.readCounter == readCounter) continue;
+    starts++;
+    sensor = (uint8_t)(handle - scheduler->sensors);
+    if (lastStartMs[sensor] != 0xffffffffUL) TEST_ASSERT(ms - lastStartMs[sensor] >= DHT22_MINREADINTERVAL);
+    if (lastAnyStartMs != 0xffffffffUL) TEST_ASSERT(ms - lastAnyStartMs >= DHT22_SCHEDULERSLOTTIME);
+    lastStartMs[sensor] = ms;
+    lastAnyStartMs = ms;
+  }
+  return starts;
+}
+
+static void test_schedulerMinInterval(void)
+{
+  DHT22_Handle_t sensors[1] = { { 0 } };
+  DHT22_Scheduler_t scheduler;
+  uint32_t lastStartMs[1] = { 0xffffffffUL };
+
+  DHT22_hostInit();
+  DHT22_hostSetResponse(0, toggles, DHT22_hostEncodeFrame(500, 200, toggles));
+  DHT22_initSensor(&sensors[0], &DHT22_hostPin[0]);
+  DHT22_initScheduler(&scheduler, sensors, 1, 0);
+  /* a single sensor is read at 0, 2s and 4s although slots are shorter */
+  TEST_ASSERT_EQUAL(3, runScheduler(&scheduler, 0, 6000, lastStartMs));
+  TEST_ASSERT_EQUAL(0, sensors[0].statistics.failedReadCounter);
+}
+
+static void test_schedulerStall(void)
+{
+  DHT22_Handle_t sensors[DHT22_HOSTNUMBEROFLINES] = { { 0 } };
+  DHT22_Scheduler_t scheduler;
+  uint32_t lastStartMs[DHT22_HOSTNUMBEROFLINES];
+  uint8_t line;
+
+  DHT22_hostInit();
+  for (line = 0; line < DHT22_HOSTNUMBEROFLINES; line++)
+  {
+    DHT22_hostSetResponse(line, toggles, DHT22_hostEncodeFrame(500 + line, 200, toggles));
+    DHT22_initSensor(&sensors[line], &DHT22_hostPin[line]);
+    lastStartMs[line] = 0xffffffffUL;
+  }
+  DHT22_initScheduler(&scheduler, sensors, DHT22_HOSTNUMBEROFLINES, 0);
+  TEST_ASSERT_EQUAL(6, runScheduler(&scheduler, 0, 3000, lastStartMs));
+  /* main loop stalls for 5s, the missed slots are skipped afterwards */
+  TEST_ASSERT_EQUAL(8, runScheduler(&scheduler, 8000, 12000, lastStartMs));
+  for (line = 0; line < DHT22_HOSTNUMBEROFLINES; line++)
+  {
+    TEST_ASSERT_EQUAL(0, sensors[line].statistics.failedReadCounter);
+  }
+}
+
+static void test_schedulerEmpty(void)
+{
+  DHT22_Scheduler_t scheduler;
+
+  DHT22_initScheduler(&scheduler, NULL, 0, 0);
+  TEST_ASSERT_EQUAL(0, scheduler.current);
+  TEST_ASSERT(DHT22_runScheduler(&scheduler, 0, DHT22_SCHEDULERSLOTTIME) == NULL);
+}
+
+int main(void)
+{
+  TEST_RUN(test_blockingRead);
+  TEST_RUN(test_blockingStuckAtVCC);
+  TEST_RUN(test_blockingStuckAtGND);
+  TEST_RUN(test_blockingTimeout);
+  TEST_RUN(test_asyncRead);
+  TEST_RUN(test_asyncRecordedTrace);
+  TEST_RUN(test_asyncReplay);
+  TEST_RUN(test_asyncNoResponse);
+  TEST_RUN(test_asyncTimeout);
+  TEST_RUN(test_negativeTemperature);
+  TEST_RUN(test_decodeFrames);
+  TEST_RUN(test_calibration);
+  TEST_RUN(test_schedulerMinInterval);
+  TEST_RUN(test_schedulerStall);
+  TEST_RUN(test_schedulerEmpty);
+  return TEST_RESULT();
+}
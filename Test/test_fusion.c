@@ -0,0 +1,68 @@
+/*******************| Inclusions |*************************************/
+#include "test.h"
+#include "fusion.h"
+
+/**
+ * @brief Host tests of the Fusion module
+*/
+
+/*******************| Function definition |****************************/
+/**
+ * Growth factor in double precision, Q8
+ */
+static double referenceGrowthFactor(uint8_t kappa, uint16_t relativeHumidity)
+{
+  return (1.0 + kappa / 256.0 / 1.65 * relativeHumidity / (1000.0 - relativeHumidity)) * 256.0;
+}
+
+static void test_growthFactor(void)
+{
+  const uint8_t kappas[] = { 0, 1, 102, 217, 218, 255 };
+  uint16_t relativeHumidity;
+  uint8_t kappa;
+
+  TEST_ASSERT_EQUAL(0x100, Fusion_growthFactor(102, 0));
+  /* no wrap around up to 99.9%RH for any kappa, within the Q8 step and the
+   * rounding of 1 / 1.65 (0.1%) */
+  for (kappa = 0; kappa < sizeof(kappas); kappa++)
+  {
+    for (relativeHumidity = 0; relativeHumidity < 1000; relativeHumidity++)
+    {
+      TEST_ASSERT_WITHIN(1 + referenceGrowthFactor(kappas[kappa], relativeHumidity) / 1000, referenceGrowthFactor(kappas[kappa], relativeHumidity), Fusion_growthFactor(kappas[kappa], relativeHumidity));
+    }
+  }
+  TEST_ASSERT(Fusion_growthFactor(255, 999) > 0xffff);
+  /* 100%RH would divide by zero */
+  TEST_ASSERT_EQUAL(Fusion_growthFactor(255, 999), Fusion_growthFactor(255, 1000));
+}
+
+static void test_correct(void)
+{
+  const Fusion_Config_t config = { 255, 999, 600 };
+  Fusion_t fusion;
+  uint32_t corrected;
+
+  Fusion_init(&fusion, NULL);
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_NOHUMIDITY, Fusion_correct(&fusion, 100000, 0, 0, &corrected));
+  TEST_ASSERT_EQUAL(100000, corrected);
+  Fusion_setHumidity(&fusion, 500, 1000);
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_OK, Fusion_correct(&fusion, 100000, 1100, 0, &corrected));
+  /* C = 1.241, Q8 truncates to 1.238 */
+  TEST_ASSERT_WITHIN(300, 100000 / 1.2415, corrected);
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_STALEHUMIDITY, Fusion_correct(&fusion, 100000, 1601, 0, &corrected));
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_INPUTERROR, Fusion_correct(&fusion, 100000, 900, 4, &corrected));
+  /* largest growth: C = 604 */
+  Fusion_init(&fusion, &config);
+  Fusion_setHumidity(&fusion, 1000, 0);
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_HUMIDITYLIMIT, Fusion_correct(&fusion, 100000, 0, 0, &corrected));
+  TEST_ASSERT_WITHIN(2, 165, corrected);
+  TEST_ASSERT_EQUAL(FUSION_QUALITY_HUMIDITYLIMIT, Fusion_correct(&fusion, 0xffffffffUL, 0, 0, &corrected));
+  TEST_ASSERT_WITHIN(0xffffffffUL / 604 / 100, 0xffffffffUL / 604, corrected);
+}
+
+int main(void)
+{
+  TEST_RUN(test_growthFactor);
+  TEST_RUN(test_correct);
+  return TEST_RESULT();
+}
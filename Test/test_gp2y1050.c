@@ -0,0 +1,112 @@
+/*******************| Inclusions |*************************************/
+#include "test.h"
+#include "gp2y1050_hal.h"
+
+/**
+ * @brief Host tests of the GP2Y1050 module, directly through
+ * GP2Y1050_adcCallback and with the simulated ADC of the host backend
+*/
+
+/*******************| Function definition |****************************/
+static void runBurst(uint16_t sample, uint8_t numberOfSamples)
+{
+  uint8_t i;
+
+  TEST_ASSERT_EQUAL(GP2Y1050State_Sampling, GP2Y1050_startBurst(numberOfSamples));
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    GP2Y1050_adcCallback(sample);
+  }
+}
+
+static void test_burst(void)
+{
+  uint16_t density = 0;
+  /* voltage of a sample at the middle of the 30ug/m^3 step */
+  uint16_t sample = (uint16_t)((((uint32_t)GP2Y1050_NODUSTVOLTAGEMV + 30 * GP2Y1050_SENSITIVITYMVPERUG + GP2Y1050_SENSITIVITYMVPERUG / 2) << GP2Y1050_ADCRESOLUTIONBITS) / GP2Y1050_ADCFULLSCALEMV);
+
+  GP2Y1050_init();
+  TEST_ASSERT_EQUAL(GP2Y1050_NOT_OK, GP2Y1050_readDustDensity(&density));
+  runBurst(sample, 8);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadDone, GP2Y1050_poll());
+  TEST_ASSERT_EQUAL(GP2Y1050_OK, GP2Y1050_readDustDensity(&density));
+  TEST_ASSERT_EQUAL(30, density);
+}
+
+static void test_noSignal(void)
+{
+  GP2Y1050_init();
+  runBurst(0, 8);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadErrorImplausible, GP2Y1050_poll());
+}
+
+static void test_saturated(void)
+{
+  const uint16_t fullScale = (uint16_t)((1UL << GP2Y1050_ADCRESOLUTIONBITS) - 1);
+  uint8_t i;
+
+  GP2Y1050_init();
+  runBurst(fullScale, 16);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadErrorImplausible, GP2Y1050_poll());
+  /* a single saturated sample is an outlier, not a saturated ADC */
+  TEST_ASSERT_EQUAL(GP2Y1050State_Sampling, GP2Y1050_startBurst(16));
+  for (i = 0; i < 15; i++)
+  {
+    GP2Y1050_adcCallback(750);
+  }
+  GP2Y1050_adcCallback(fullScale);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadDone, GP2Y1050_poll());
+}
+
+static void test_simulatedAdc(void)
+{
+  GP2Y1050_Statistics_t statistics;
+  uint16_t density = 0;
+
+  GP2Y1050_hostInit();
+  /* 30.4ug/m^3 with +-20mV noise */
+  GP2Y1050_hostSetVoltage(GP2Y1050_NODUSTVOLTAGEMV + 152, 20);
+  GP2Y1050_init();
+  TEST_ASSERT_EQUAL(GP2Y1050State_Sampling, GP2Y1050_startBurst(16));
+  /* the first conversion is GP2Y1050_SAMPLEDELAY into the first LED pulse */
+  GP2Y1050_hostRunUntil(GP2Y1050_HOSTPULSEPERIOD - GP2Y1050_LEDPULSETIME + GP2Y1050_SAMPLEDELAY - 1);
+  TEST_ASSERT_EQUAL(0, GP2Y1050_hostPulseCounter);
+  GP2Y1050_hostRunUntil(GP2Y1050_HOSTPULSEPERIOD - GP2Y1050_LEDPULSETIME + GP2Y1050_SAMPLEDELAY);
+  TEST_ASSERT_EQUAL(1, GP2Y1050_hostPulseCounter);
+  TEST_ASSERT_EQUAL(GP2Y1050State_Sampling, GP2Y1050_poll());
+  GP2Y1050_hostRunUntil(16 * GP2Y1050_HOSTPULSEPERIOD);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadDone, GP2Y1050_poll());
+  TEST_ASSERT_EQUAL(GP2Y1050_OK, GP2Y1050_readDustDensity(&density));
+  TEST_ASSERT_WITHIN(2, 30, density);
+  /* the pulse train stopped with the last sample */
+  GP2Y1050_hostRunUntil(20 * GP2Y1050_HOSTPULSEPERIOD);
+  TEST_ASSERT_EQUAL(16, GP2Y1050_hostPulseCounter);
+  GP2Y1050_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(0, statistics.lostSampleCounter);
+}
+
+static void test_outliers(void)
+{
+  /* single spikes in both directions are trimmed */
+  static const uint16_t samples[8] = { 700, 700, (1 << GP2Y1050_ADCRESOLUTIONBITS) - 1, 700, 700, 0, 700, 700 };
+  uint16_t density = 0;
+
+  GP2Y1050_hostInit();
+  GP2Y1050_hostSetSamples(samples, 8);
+  GP2Y1050_init();
+  TEST_ASSERT_EQUAL(GP2Y1050State_Sampling, GP2Y1050_startBurst(8));
+  GP2Y1050_hostRunUntil(8 * GP2Y1050_HOSTPULSEPERIOD);
+  TEST_ASSERT_EQUAL(GP2Y1050State_ReadDone, GP2Y1050_poll());
+  TEST_ASSERT_EQUAL(GP2Y1050_OK, GP2Y1050_readDustDensity(&density));
+  TEST_ASSERT_EQUAL(GP2Y1050_calculateDustDensity(700), density);
+}
+
+int main(void)
+{
+  TEST_RUN(test_burst);
+  TEST_RUN(test_noSignal);
+  TEST_RUN(test_saturated);
+  TEST_RUN(test_simulatedAdc);
+  TEST_RUN(test_outliers);
+  return TEST_RESULT();
+}
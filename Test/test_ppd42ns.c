@@ -0,0 +1,587 @@
+/*******************| Inclusions |*************************************/
+#include <pthread.h>
+#include "test.h"
+#include "ppd42ns_hal.h"
+
+/**
+ * @brief Host tests of the PPD42NS module on the simulated Timer1
+*/
+
+/*******************| Macros |*****************************************/
+#define STRESS_NUMBEROFBUCKETS          4
+#define STRESS_NUMBEROFWINDOWS          50000
+#define STRESS_LOWTIME                  1000
+#define REPLAY_NUMBEROFPULSES           200
+#define REPLAY_PULSEPERIOD              8192
+#define REPLAY_LOWTIME                  1000
+
+/*******************| Global variables |*******************************/
+static volatile uint8_t stressDone;
+static uint16_t windowCallbacks;
+static uint8_t publishInCopy;
+static Trace_Event_t replayTrace[2 * REPLAY_NUMBEROFPULSES];
+
+/*******************| Function definition |****************************/
+/**
+ * One low pulse per channel and timer period, the pulse of channel n is
+ * (n + 1) * lowTime long
+ */
+static void runPulses(uint16_t periods, uint16_t lowTime)
+{
+  uint8_t channel;
+
+  while (periods--)
+  {
+    for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+    {
+      PPD42NS_hostEdge(channel, 0, (uint16_t)(1000 + channel * 10000));
+      PPD42NS_hostEdge(channel, 1, (uint16_t)(1000 + channel * 10000 + (channel + 1) * lowTime));
+    }
+    PPD42NS_hostOverflow();
+  }
+}
+
+static void test_ratio(void)
+{
+  PPD42NS_Snapshot_t snapshot;
+  uint16_t ratio;
+  uint8_t channel;
+
+  PPD42NS_init(NULL);
+  runPulses(PPD42NS_DEFAULTBUCKETLENGTH * PPD42NS_DEFAULTNUMBEROFBUCKETS, 650);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(PPD42NS_DEFAULTNUMBEROFBUCKETS, snapshot.windowId);
+  TEST_ASSERT_EQUAL(0, snapshot.flags);
+  TEST_ASSERT_EQUAL(PPD42NS_DEFAULTNUMBEROFBUCKETS * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL, snapshot.windowTime);
+  for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+  {
+    /* ratio in Q16 of a 65536 tick period equals the pulse length */
+    TEST_ASSERT_EQUAL(PPD42NS_OK, PPD42NS_readRatio(channel / PPD42NS_CHANNELSPERSENSOR, channel % PPD42NS_CHANNELSPERSENSOR, &ratio));
+    TEST_ASSERT_WITHIN(1, (channel + 1) * 650, ratio);
+  }
+  TEST_ASSERT_EQUAL(PPD42NS_NOT_OK, PPD42NS_readRatio(PPD42NS_NUMBEROFSENSORS, PPD42NS_CHANNEL_P1, &ratio));
+}
+
+static void countWindow(void)
+{
+  windowCallbacks++;
+}
+
+/**
+ * One low pulse of lowTime on channel 0 and one timer period
+ */
+static void runPeriod(uint16_t lowTime)
+{
+  if (lowTime)
+  {
+    PPD42NS_hostEdge(0, 0, 1000);
+    PPD42NS_hostEdge(0, 1, (uint16_t)(1000 + lowTime));
+  }
+  PPD42NS_hostOverflow();
+}
+
+static void test_warmUp(void)
+{
+  const PPD42NS_Config_t config = { 2, 4, countWindow };
+  PPD42NS_Snapshot_t snapshot;
+  uint16_t firstWindowId;
+  uint8_t bucket;
+
+  PPD42NS_init(&config);
+  PPD42NS_readSnapshot(&snapshot);
+  firstWindowId = snapshot.windowId;
+  windowCallbacks = 0;
+  for (bucket = 1; bucket <= 4; bucket++)
+  {
+    runPeriod(1000);
+    /* callback and snapshot only at the end of a bucket */
+    TEST_ASSERT_EQUAL(bucket - 1, windowCallbacks);
+    runPeriod(1000);
+    TEST_ASSERT_EQUAL(bucket, windowCallbacks);
+    PPD42NS_readSnapshot(&snapshot);
+    TEST_ASSERT_EQUAL(bucket, (uint16_t)(snapshot.windowId - firstWindowId));
+    /* the window grows with the buckets filled so far */
+    TEST_ASSERT_EQUAL(bucket * 2 * 0x10000UL, snapshot.windowTime);
+    TEST_ASSERT_EQUAL(bucket * 2 * 1000UL, snapshot.lowPulseOccupancy[0]);
+    TEST_ASSERT_EQUAL((bucket < 4) ? PPD42NS_SNAPSHOTFLAG_WARMUP : 0, snapshot.flags);
+  }
+}
+
+static void test_slidingWindow(void)
+{
+  const PPD42NS_Config_t config = { 1, 4, NULL };
+  PPD42NS_Snapshot_t snapshot;
+  uint8_t bucket;
+
+  PPD42NS_init(&config);
+  /* bucket n has a pulse of n * 100 ticks */
+  for (bucket = 1; bucket <= 6; bucket++)
+  {
+    runPeriod((uint16_t)(bucket * 100));
+  }
+  /* buckets 1 and 2 were replaced by 5 and 6 */
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(4 * 0x10000UL, snapshot.windowTime);
+  TEST_ASSERT_EQUAL(300 + 400 + 500 + 600, snapshot.lowPulseOccupancy[0]);
+  for (bucket = 1; bucket <= 3; bucket++)
+  {
+    runPeriod(0);
+  }
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(600, snapshot.lowPulseOccupancy[0]);
+  runPeriod(0);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0, snapshot.lowPulseOccupancy[0]);
+}
+
+static void test_invalidConfig(void)
+{
+  const PPD42NS_Config_t zero = { 0, 0, NULL };
+  const PPD42NS_Config_t oversized = { 1, PPD42NS_MAXNUMBEROFBUCKETS + 1, NULL };
+  PPD42NS_Snapshot_t snapshot;
+  uint16_t windowId;
+  uint8_t bucket;
+
+  /* zero is replaced by the defaults: no bucket closes before
+   * PPD42NS_DEFAULTBUCKETLENGTH overflows */
+  PPD42NS_init(&zero);
+  PPD42NS_readSnapshot(&snapshot);
+  windowId = snapshot.windowId;
+  PPD42NS_hostRunUntil((PPD42NS_DEFAULTBUCKETLENGTH - 1) * 0x10000UL);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(windowId, snapshot.windowId);
+  PPD42NS_hostRunUntil(PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(windowId + 1, snapshot.windowId);
+  TEST_ASSERT_EQUAL(PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL, snapshot.windowTime);
+  /* warm-up ends after PPD42NS_DEFAULTNUMBEROFBUCKETS */
+  PPD42NS_hostRunUntil((PPD42NS_DEFAULTNUMBEROFBUCKETS - 1) * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(PPD42NS_SNAPSHOTFLAG_WARMUP, snapshot.flags & PPD42NS_SNAPSHOTFLAG_WARMUP);
+  PPD42NS_hostRunUntil(PPD42NS_DEFAULTNUMBEROFBUCKETS * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0, snapshot.flags & PPD42NS_SNAPSHOTFLAG_WARMUP);
+  /* more buckets than PPD42NS_MAXNUMBEROFBUCKETS: default window */
+  PPD42NS_init(&oversized);
+  for (bucket = 1; bucket < PPD42NS_DEFAULTNUMBEROFBUCKETS; bucket++)
+  {
+    runPeriod(0);
+  }
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(PPD42NS_SNAPSHOTFLAG_WARMUP, snapshot.flags & PPD42NS_SNAPSHOTFLAG_WARMUP);
+  runPeriod(0);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0, snapshot.flags & PPD42NS_SNAPSHOTFLAG_WARMUP);
+  TEST_ASSERT_EQUAL(PPD42NS_DEFAULTNUMBEROFBUCKETS * 0x10000UL, snapshot.windowTime);
+}
+
+/**
+ * Low pulse of length ticks on a channel starting 100 ticks from now, timer
+ * overflows in between are delivered
+ */
+static void runPulse(uint8_t channel, uint32_t length)
+{
+  uint32_t start = PPD42NS_hostTime + 100;
+
+  PPD42NS_hostRunUntil(start);
+  PPD42NS_hostEdge(channel, 0, (uint16_t)start);
+  PPD42NS_hostRunUntil(start + length);
+  PPD42NS_hostEdge(channel, 1, (uint16_t)(start + length));
+}
+
+static void test_histogram(void)
+{
+  const PPD42NS_Config_t config = { 8, 4, NULL };
+  const uint32_t pulses[] = { 500, 1023, 1024, 2047, 2048, 50000, PPD42NS_MAXLOWPULSE, PPD42NS_MAXLOWPULSE + 1 };
+  const uint8_t expected[PPD42NS_HISTOGRAMBINS] = { 2, 2, 1, 0, 0, 0, 1, 1 };
+  PPD42NS_Snapshot_t snapshot;
+  uint32_t occupancy = 0;
+  uint8_t pulse;
+  uint8_t bin;
+
+  /* all pulses within one bucket */
+  PPD42NS_init(&config);
+  for (pulse = 0; pulse < sizeof(pulses) / sizeof(pulses[0]); pulse++)
+  {
+    runPulse(0, pulses[pulse]);
+    if (pulses[pulse] <= PPD42NS_MAXLOWPULSE) occupancy += pulses[pulse];
+  }
+  TEST_ASSERT(PPD42NS_hostTime < 8 * 0x10000UL);
+  PPD42NS_hostRunUntil(8 * 0x10000UL);
+  PPD42NS_readSnapshot(&snapshot);
+  for (bin = 0; bin < PPD42NS_HISTOGRAMBINS; bin++)
+  {
+    TEST_ASSERT_EQUAL(expected[bin], snapshot.pulseStatistics[0].histogram[bin]);
+  }
+  /* the pulse above PPD42NS_MAXLOWPULSE is not part of the occupancy */
+  TEST_ASSERT_EQUAL(1, snapshot.pulseStatistics[0].rejectedPulses);
+  TEST_ASSERT_EQUAL(0, snapshot.pulseStatistics[0].edgeErrors);
+  TEST_ASSERT_EQUAL(occupancy, snapshot.lowPulseOccupancy[0]);
+  TEST_ASSERT_EQUAL(0x01, snapshot.errorChannels);
+  TEST_ASSERT(snapshot.flags & PPD42NS_SNAPSHOTFLAG_EDGEERROR);
+}
+
+static void test_edgeErrors(void)
+{
+  const PPD42NS_Config_t config = { 1, 4, NULL };
+  PPD42NS_Snapshot_t snapshot;
+  uint8_t bucket;
+
+  PPD42NS_init(&config);
+  runPeriod(1000);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0, snapshot.errorChannels);
+  /* LOW -> HIGH edge lost: two HIGH -> LOW edges in a row, the second one
+   * starts the pulse. HIGH -> LOW edge lost: LOW -> HIGH edge without a pulse
+   * running on channel 1 */
+  PPD42NS_hostEdge(0, 0, 1000);
+  PPD42NS_hostEdge(0, 0, 2000);
+  PPD42NS_hostEdge(0, 1, 2500);
+  PPD42NS_hostEdge(1, 1, 3000);
+  PPD42NS_hostOverflow();
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(1, snapshot.pulseStatistics[0].edgeErrors);
+  TEST_ASSERT_EQUAL(1, snapshot.pulseStatistics[1].edgeErrors);
+  TEST_ASSERT_EQUAL(1, snapshot.pulseStatistics[0].histogram[0]);
+  TEST_ASSERT_EQUAL(1000 + 500, snapshot.lowPulseOccupancy[0]);
+  TEST_ASSERT_EQUAL(0x03, snapshot.errorChannels);
+  TEST_ASSERT(snapshot.flags & PPD42NS_SNAPSHOTFLAG_EDGEERROR);
+  /* the flag stays while the faulty bucket is in the window of 4 buckets,
+   * statistics only show the newest bucket */
+  for (bucket = 1; bucket < 4; bucket++)
+  {
+    runPeriod(1000);
+    PPD42NS_readSnapshot(&snapshot);
+    TEST_ASSERT_EQUAL(0, snapshot.pulseStatistics[0].edgeErrors);
+    TEST_ASSERT_EQUAL(0x03, snapshot.errorChannels);
+    TEST_ASSERT(snapshot.flags & PPD42NS_SNAPSHOTFLAG_EDGEERROR);
+  }
+  runPeriod(1000);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0, snapshot.errorChannels);
+  TEST_ASSERT_EQUAL(0, snapshot.flags & PPD42NS_SNAPSHOTFLAG_EDGEERROR);
+}
+
+/**
+ * Window callback making each ISR run closing a bucket take 40 ticks
+ */
+static void slowWindow(void)
+{
+  PPD42NS_hostTime += 40;
+}
+
+/**
+ * Barrier hook publishing a window while PPD42NS_readSnapshot copies
+ */
+static void publishWindow(void)
+{
+  if (!publishInCopy) return;
+  publishInCopy = 0;
+  PPD42NS_hostOverflow();
+}
+
+static void test_statistics(void)
+{
+  const PPD42NS_Config_t config = { 1, 4, slowWindow };
+  PPD42NS_Statistics_t statistics;
+  PPD42NS_Snapshot_t snapshot;
+  uint16_t windowId;
+  uint8_t period;
+
+  PPD42NS_init(&config);
+  /* every period has 2 edges and an overflow, i.e. 3 ISR runs */
+  for (period = 0; period < 8; period++)
+  {
+    runPeriod(1000);
+  }
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(8 * 3, statistics.isrCounter);
+  TEST_ASSERT_EQUAL(40, statistics.isrMaxTime);
+  TEST_ASSERT(statistics.isrAverageTime < 40 * 16);
+  /* with only slow runs the average settles at 40 ticks (Q4, 1/16 steps) */
+  for (period = 0; period < 200; period++)
+  {
+    runPeriod(0);
+  }
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(8 * 3 + 200, statistics.isrCounter);
+  TEST_ASSERT_EQUAL(40, statistics.isrAverageTime >> 4);
+  /* 208 windows published, the first wait returns one of them, the others
+   * were missed */
+  TEST_ASSERT_EQUAL(0, statistics.windowOverruns);
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(207, statistics.windowOverruns);
+  runPeriod(0);
+  runPeriod(0);
+  runPeriod(0);
+  PPD42NS_waitForNextSenorValue();
+  /* waiting in time misses nothing */
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(209, statistics.windowOverruns);
+  /* a window published during the copy repeats it */
+  TEST_ASSERT_EQUAL(0, statistics.snapshotRetries);
+  PPD42NS_readSnapshot(&snapshot);
+  windowId = snapshot.windowId;
+  PPD42NS_hostBarrierHook = publishWindow;
+  publishInCopy = 1;
+  PPD42NS_readSnapshot(&snapshot);
+  PPD42NS_hostBarrierHook = NULL;
+  TEST_ASSERT_EQUAL(windowId + 1, snapshot.windowId);
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(1, statistics.snapshotRetries);
+  /* init starts over, windows published before are no overruns */
+  PPD42NS_init(&config);
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(0, statistics.windowOverruns);
+  TEST_ASSERT_EQUAL(0, statistics.snapshotRetries);
+  TEST_ASSERT_EQUAL(1, statistics.isrCounter);
+}
+
+static void test_sleepAccounting(void)
+{
+  const PPD42NS_Config_t config = { 4, 4, NULL };
+  const uint32_t bucketTime = 4 * 0x10000UL;
+  PPD42NS_Statistics_t statistics;
+
+  PPD42NS_init(&config);
+  /* active for a part of the bucket, asleep for the rest of it */
+  PPD42NS_hostRunUntil(PPD42NS_hostTime + 1000);
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(bucketTime, PPD42NS_hostTime);
+  TEST_ASSERT_EQUAL(1000, statistics.lastActiveTime);
+  TEST_ASSERT_EQUAL(bucketTime - 1000, statistics.lastSleepTime);
+  TEST_ASSERT_EQUAL(bucketTime, statistics.lastActiveTime + statistics.lastSleepTime);
+  /* a low pulse in the active part is counted as active */
+  PPD42NS_hostEdge(0, 0, 1000);
+  PPD42NS_hostEdge(0, 1, 3000);
+  PPD42NS_hostRunUntil(PPD42NS_hostTime + 2000);
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(2 * bucketTime, PPD42NS_hostTime);
+  TEST_ASSERT_EQUAL(5000, statistics.lastActiveTime);
+  TEST_ASSERT_EQUAL(bucketTime - 5000, statistics.lastSleepTime);
+  TEST_ASSERT_EQUAL(bucketTime, statistics.lastActiveTime + statistics.lastSleepTime);
+  /* active beyond the end of the bucket, the wait returns without sleeping */
+  PPD42NS_hostRunUntil(PPD42NS_hostTime + bucketTime + 2000);
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(bucketTime + 2000, statistics.lastActiveTime);
+  TEST_ASSERT_EQUAL(0, statistics.lastSleepTime);
+  /* the next bucket is the rest of it */
+  PPD42NS_waitForNextSenorValue();
+  PPD42NS_readStatistics(&statistics);
+  TEST_ASSERT_EQUAL(4 * bucketTime, PPD42NS_hostTime);
+  TEST_ASSERT_EQUAL(0, statistics.lastActiveTime);
+  TEST_ASSERT_EQUAL(bucketTime - 2000, statistics.lastSleepTime);
+}
+
+static void test_readTime(void)
+{
+  uint32_t time;
+
+  PPD42NS_init(NULL);
+  PPD42NS_hostRunUntil(0x2fff0UL);
+  time = PPD42NS_readTime();
+  TEST_ASSERT_EQUAL(0x2fff0UL, time);
+  PPD42NS_hostRunUntil(0x30010UL);
+  TEST_ASSERT_EQUAL(0x20, PPD42NS_readTime() - time);
+}
+
+/**
+ * Datasheet curve in double precision, polynomial fit in particles/0.01cf
+ * converted to particles/m^3
+ * @param percent low occupancy ratio in percent
+ */
+static double referenceConcentration(double percent)
+{
+  return (((1.1 * percent - 3.8) * percent + 520.0) * percent + 0.62) * 3531.47;
+}
+
+static void test_ratioAccuracy(void)
+{
+  const uint32_t windowTime = PPD42NS_DEFAULTNUMBEROFBUCKETS * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL;
+  uint32_t maxError = 0;
+  uint32_t lowPulseOccupancy;
+  double reference;
+  double error;
+
+  for (lowPulseOccupancy = 0; lowPulseOccupancy <= windowTime; lowPulseOccupancy += windowTime / 10007)
+  {
+    reference = (double)lowPulseOccupancy * 65536.0 / windowTime;
+    if (reference > 65535.0) reference = 65535.0;
+    error = reference - PPD42NS_calculateRatio(lowPulseOccupancy, windowTime);
+    if (error < 0) error = -error;
+    if (error > maxError) maxError = (uint32_t)(error + 0.5);
+  }
+  /* truncated once by the division and once by scaling down */
+  TEST_ASSERT(maxError <= 2);
+  TEST_ASSERT_EQUAL(0xffff, PPD42NS_calculateRatio(windowTime, windowTime));
+  TEST_ASSERT_EQUAL(0, PPD42NS_calculateRatio(1000, 0));
+}
+
+static void test_concentrationAccuracy(void)
+{
+  const uint32_t windowTime = PPD42NS_DEFAULTNUMBEROFBUCKETS * PPD42NS_DEFAULTBUCKETLENGTH * 0x10000UL;
+  uint32_t lowPulseOccupancy;
+  uint32_t concentration;
+  double percent;
+  double error;
+  double maxErrorAbove01 = 0;
+  double maxErrorAbove05 = 0;
+
+  /* ratios 0.1% .. 20% of a default window, from the counters on as
+   * PPD42NS_readValue does */
+  for (lowPulseOccupancy = windowTime / 1000; lowPulseOccupancy <= windowTime / 5; lowPulseOccupancy += windowTime / 20011)
+  {
+    percent = (double)lowPulseOccupancy * 100.0 / windowTime;
+    concentration = PPD42NS_calculateConcentration(PPD42NS_calculateRatio(lowPulseOccupancy, windowTime));
+    error = (concentration - referenceConcentration(percent)) / referenceConcentration(percent);
+    if (error < 0) error = -error;
+    if (error > maxErrorAbove01) maxErrorAbove01 = error;
+    if ((percent > 0.5) && (error > maxErrorAbove05)) maxErrorAbove05 = error;
+  }
+  printf("  max. error: %.3f%% above 0.1%%, %.3f%% above 0.5%%\n", maxErrorAbove01 * 100, maxErrorAbove05 * 100);
+  TEST_ASSERT(maxErrorAbove05 < 0.01);
+  TEST_ASSERT(maxErrorAbove01 < 0.03);
+  /* beyond the datasheet curve the value is clamped */
+  TEST_ASSERT_EQUAL(PPD42NS_calculateConcentration(0x3334), PPD42NS_calculateConcentration(0xffff));
+}
+
+/**
+ * Interrupt thread: every bucket is a single timer period with one low pulse of
+ * STRESS_LOWTIME on every channel
+ */
+static void *stressIsrThread(void *argument)
+{
+  uint16_t window;
+  uint8_t channel;
+
+  (void)argument;
+  for (window = 0; window < STRESS_NUMBEROFWINDOWS; window++)
+  {
+    for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+    {
+      PPD42NS_hostEdge(channel, 0, (uint16_t)(1000 + channel * 10000));
+      PPD42NS_hostEdge(channel, 1, (uint16_t)(1000 + channel * 10000 + STRESS_LOWTIME));
+    }
+    PPD42NS_hostOverflow();
+  }
+  stressDone = 1;
+  return NULL;
+}
+
+static void test_snapshotStress(void)
+{
+  const PPD42NS_Config_t config = { 1, STRESS_NUMBEROFBUCKETS, NULL };
+  PPD42NS_Snapshot_t snapshot;
+  pthread_t isrThread;
+  uint16_t firstWindowId;
+  uint16_t buckets;
+  uint32_t reads = 0;
+  uint32_t torn = 0;
+  uint8_t channel;
+
+  PPD42NS_init(&config);
+  PPD42NS_readSnapshot(&snapshot);
+  firstWindowId = snapshot.windowId;
+  stressDone = 0;
+  TEST_ASSERT_EQUAL(0, pthread_create(&isrThread, NULL, stressIsrThread, NULL));
+  /* main loop thread: every copy must belong to a single window */
+  while (!stressDone)
+  {
+    PPD42NS_readSnapshot(&snapshot);
+    /* snapshot of the previous test until the first window closed */
+    if (snapshot.windowId == firstWindowId) continue;
+    buckets = (uint16_t)(snapshot.windowId - firstWindowId);
+    if (buckets > STRESS_NUMBEROFBUCKETS) buckets = STRESS_NUMBEROFBUCKETS;
+    if (snapshot.windowTime != buckets * 0x10000UL) torn++;
+    for (channel = 0; channel < PPD42NS_NUMBEROFCHANNELS; channel++)
+    {
+      if (snapshot.lowPulseOccupancy[channel] != (uint32_t)buckets * STRESS_LOWTIME) torn++;
+    }
+    reads++;
+  }
+  pthread_join(isrThread, NULL);
+  TEST_ASSERT_EQUAL(0, torn);
+  TEST_ASSERT(reads > 0);
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(STRESS_NUMBEROFWINDOWS, (uint16_t)(snapshot.windowId - firstWindowId));
+}
+
+static void test_captureBeforeHandledOverflow(void)
+{
+  const PPD42NS_Config_t config = { 2, 1, NULL };
+  PPD42NS_Snapshot_t snapshot;
+
+  PPD42NS_init(&config);
+  PPD42NS_hostEdge(0, 0, 0x8000);
+  /* the ISR read the channel flags, then the rising edge was captured at
+   * 0xfff0, the timer overflowed and the ISR handled the overflow */
+  PPD42NS_hostOverflow();
+  PPD42NS_hostTime += 5;
+  PPD42NS_hostPins |= 0x01;
+  PPD42NS_hostCapture[0] = 0xfff0;
+  PPD42NS_hostPendingChannels |= 0x01;
+  /* next run of the ISR gets the capture: 0x7ff0 long, not a period more */
+  PPD42NS_inputCaptureISR();
+  PPD42NS_hostOverflow();
+  PPD42NS_readSnapshot(&snapshot);
+  TEST_ASSERT_EQUAL(0x7ff0, snapshot.lowPulseOccupancy[0]);
+  TEST_ASSERT_EQUAL(0, snapshot.pulseStatistics[0].rejectedPulses);
+  TEST_ASSERT_EQUAL(0, snapshot.pulseStatistics[0].edgeErrors);
+}
+
+static void test_replay(void)
+{
+  const PPD42NS_Config_t config = { 1, 4, NULL };
+  Trace_Distortion_t distortion = { 0, 0, 0 };
+  uint16_t ratio;
+  uint16_t pulse;
+
+  /* 1000us low every 16384us on channel 0, i.e. 16 pulses per window of 4
+   * periods, channel 6 is not connected */
+  for (pulse = 0; pulse < REPLAY_NUMBEROFPULSES; pulse++)
+  {
+    replayTrace[2 * pulse].timestamp = (uint32_t)pulse * REPLAY_PULSEPERIOD;
+    replayTrace[2 * pulse].channel = (pulse & 1) ? 6 : 0;
+    replayTrace[2 * pulse].level = 0;
+    replayTrace[2 * pulse + 1].timestamp = (uint32_t)pulse * REPLAY_PULSEPERIOD + REPLAY_LOWTIME;
+    replayTrace[2 * pulse + 1].channel = (pulse & 1) ? 6 : 0;
+    replayTrace[2 * pulse + 1].level = 1;
+  }
+  PPD42NS_init(&config);
+  PPD42NS_hostReplay(replayTrace, 2 * REPLAY_NUMBEROFPULSES, NULL);
+  TEST_ASSERT_EQUAL(PPD42NS_OK, PPD42NS_readRatio(0, PPD42NS_CHANNEL_P1, &ratio));
+  TEST_ASSERT_WITHIN(2, 0x10000UL * REPLAY_LOWTIME / (2 * REPLAY_PULSEPERIOD), ratio);
+  /* jitter averages out, latency and skew do not change pulse lengths much,
+   * edges are captured before overflows pending at ISR entry */
+  distortion.skewPpm = 500;
+  distortion.jitter = 10;
+  distortion.latency = 80;
+  PPD42NS_hostReplay(replayTrace, 2 * REPLAY_NUMBEROFPULSES, &distortion);
+  TEST_ASSERT_EQUAL(PPD42NS_OK, PPD42NS_readRatio(0, PPD42NS_CHANNEL_P1, &ratio));
+  TEST_ASSERT_WITHIN(40, 0x10000UL * REPLAY_LOWTIME / (2 * REPLAY_PULSEPERIOD), ratio);
+}
+
+int main(void)
+{
+  TEST_RUN(test_ratio);
+  TEST_RUN(test_warmUp);
+  TEST_RUN(test_slidingWindow);
+  TEST_RUN(test_invalidConfig);
+  TEST_RUN(test_histogram);
+  TEST_RUN(test_edgeErrors);
+  TEST_RUN(test_statistics);
+  TEST_RUN(test_sleepAccounting);
+  TEST_RUN(test_readTime);
+  TEST_RUN(test_ratioAccuracy);
+  TEST_RUN(test_concentrationAccuracy);
+  TEST_RUN(test_snapshotStress);
+  TEST_RUN(test_captureBeforeHandledOverflow);
+  TEST_RUN(test_replay);
+  return TEST_RESULT();
+}
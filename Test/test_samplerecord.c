@@ -0,0 +1,176 @@
+/*******************| Inclusions |*************************************/
+#include "test.h"
+#include "samplerecord.h"
+
+/**
+ * @brief Host tests of the SampleRecord module
+*/
+
+/*******************| Macros |*****************************************/
+#define TEST_STORESIZE                  8
+
+/*******************| Global variables |*******************************/
+static uint8_t buffer[256];
+
+/*******************| Function definition |****************************/
+static SampleRecord_t makeRecord(uint32_t timestamp, uint8_t sensorId, sint32_t value, uint8_t status)
+{
+  SampleRecord_t record;
+
+  record.timestamp = timestamp;
+  record.sensorId = sensorId;
+  record.value = value;
+  record.status = status;
+  return record;
+}
+
+static void expectRecord(const SampleRecord_t *expected, const SampleRecord_t *actual)
+{
+  TEST_ASSERT_EQUAL(expected->timestamp, actual->timestamp);
+  TEST_ASSERT_EQUAL(expected->sensorId, actual->sensorId);
+  TEST_ASSERT_EQUAL(expected->value, actual->value);
+  TEST_ASSERT_EQUAL(expected->status, actual->status);
+}
+
+static void test_roundTrip(void)
+{
+  const SampleRecord_t records[] = {
+    makeRecord(100, 0, 227, 0),
+    makeRecord(100, 1, 584, 0),
+    makeRecord(102, 0, 226, 0),
+    makeRecord(102, 1, 590, 3),
+    /* extremes of value and time delta */
+    makeRecord(0xffffffffUL, 2, 0x7fffffffL, 0xff),
+    makeRecord(0xffffffffUL, 2, -0x7fffffffL - 1, 0),
+    makeRecord(0xffffffffUL, SAMPLERECORD_MAXSENSORS - 1, -1, 0),
+  };
+  SampleRecord_Coder_t encoder;
+  SampleRecord_Coder_t decoder;
+  SampleRecord_t record;
+  uint16_t length = 0;
+  uint16_t position = 0;
+  uint8_t recordLength;
+  uint8_t index;
+
+  SampleRecord_initCoder(&encoder);
+  for (index = 0; index < sizeof(records) / sizeof(records[0]); index++)
+  {
+    recordLength = SampleRecord_encode(&encoder, &records[index], &buffer[length], sizeof(buffer) - length);
+    TEST_ASSERT(recordLength > 0);
+    TEST_ASSERT(recordLength <= SAMPLERECORD_MAXENCODEDLENGTH);
+    length += recordLength;
+    /* header, time delta 100 and value 227 zigzag take 1 + 1 + 2 bytes, the
+     * following records share the timestamp or move by small steps */
+    if (index == 3) TEST_ASSERT_EQUAL(4 + 3 + 3 + 3, length);
+  }
+  SampleRecord_initCoder(&decoder);
+  for (index = 0; index < sizeof(records) / sizeof(records[0]); index++)
+  {
+    recordLength = SampleRecord_decode(&decoder, &buffer[position], length - position, &record);
+    TEST_ASSERT(recordLength > 0);
+    if (recordLength == 0) return;
+    expectRecord(&records[index], &record);
+    position += recordLength;
+  }
+  TEST_ASSERT_EQUAL(length, position);
+}
+
+static void test_invalid(void)
+{
+  SampleRecord_Coder_t coder;
+  SampleRecord_t record = makeRecord(1000, 3, -5000, 7);
+  SampleRecord_t decoded;
+  uint8_t length;
+  uint8_t truncated;
+
+  SampleRecord_initCoder(&coder);
+  record.sensorId = SAMPLERECORD_MAXSENSORS;
+  TEST_ASSERT_EQUAL(0, SampleRecord_encode(&coder, &record, buffer, sizeof(buffer)));
+  record.sensorId = 3;
+  /* does not fit, delta state is kept */
+  length = SampleRecord_encode(&coder, &record, buffer, 3);
+  TEST_ASSERT_EQUAL(0, length);
+  TEST_ASSERT_EQUAL(0, coder.timestamp);
+  TEST_ASSERT_EQUAL(0, coder.value[3]);
+  length = SampleRecord_encode(&coder, &record, buffer, sizeof(buffer));
+  TEST_ASSERT(length > 0);
+  /* every truncation is detected */
+  for (truncated = 0; truncated < length; truncated++)
+  {
+    SampleRecord_initCoder(&coder);
+    TEST_ASSERT_EQUAL(0, SampleRecord_decode(&coder, buffer, truncated, &decoded));
+  }
+  /* reserved header bit, sensor id out of range */
+  SampleRecord_initCoder(&coder);
+  buffer[0] |= 0x80;
+  TEST_ASSERT_EQUAL(0, SampleRecord_decode(&coder, buffer, length, &decoded));
+#if (SAMPLERECORD_MAXSENSORS < 32)
+  buffer[0] = (uint8_t)((buffer[0] & ~(SAMPLERECORD_HEADER_SENSORID | 0x80)) | SAMPLERECORD_MAXSENSORS);
+  TEST_ASSERT_EQUAL(0, SampleRecord_decode(&coder, buffer, length, &decoded));
+#endif
+  /* varint longer than 5 bytes */
+  buffer[0] = 0;
+  buffer[1] = buffer[2] = buffer[3] = buffer[4] = buffer[5] = 0x80;
+  buffer[6] = 0x01;
+  TEST_ASSERT_EQUAL(0, SampleRecord_decode(&coder, buffer, 7, &decoded));
+}
+
+static void test_store(void)
+{
+  SampleRecord_t records[TEST_STORESIZE];
+  SampleRecord_Store_t store;
+  SampleRecord_Coder_t coder;
+  SampleRecord_t record;
+  uint16_t length;
+  uint16_t position;
+  uint8_t numberOfRecords;
+  uint8_t index;
+
+  SampleRecord_initStore(&store, records, TEST_STORESIZE);
+  length = SampleRecord_encodeBatch(&store, buffer, sizeof(buffer), &numberOfRecords);
+  TEST_ASSERT_EQUAL(0, length);
+  TEST_ASSERT_EQUAL(0, numberOfRecords);
+  /* overfill by 3, the oldest samples are dropped */
+  for (index = 0; index < TEST_STORESIZE + 3; index++)
+  {
+    record = makeRecord(10UL * index, (uint8_t)(index % 2), 200 + index, 0);
+    SampleRecord_append(&store, &record);
+  }
+  TEST_ASSERT_EQUAL(TEST_STORESIZE, store.count);
+  TEST_ASSERT_EQUAL(3, store.droppedCounter);
+  /* batch limited by buffer size, samples stay until consumed */
+  length = SampleRecord_encodeBatch(&store, buffer, 10, &numberOfRecords);
+  TEST_ASSERT(length <= 10);
+  TEST_ASSERT(numberOfRecords > 0);
+  TEST_ASSERT(numberOfRecords < TEST_STORESIZE);
+  TEST_ASSERT_EQUAL(TEST_STORESIZE, store.count);
+  SampleRecord_initCoder(&coder);
+  position = 0;
+  for (index = 0; index < numberOfRecords; index++)
+  {
+    position += SampleRecord_decode(&coder, &buffer[position], length - position, &record);
+    TEST_ASSERT_EQUAL(10UL * (index + 3), record.timestamp);
+    TEST_ASSERT_EQUAL(203 + index, record.value);
+  }
+  TEST_ASSERT_EQUAL(length, position);
+  SampleRecord_consume(&store, numberOfRecords);
+  TEST_ASSERT_EQUAL(TEST_STORESIZE - numberOfRecords, store.count);
+  /* the rest starts a batch of its own, i.e. with fresh delta state */
+  index = (uint8_t)(numberOfRecords + 3);
+  length = SampleRecord_encodeBatch(&store, buffer, sizeof(buffer), &numberOfRecords);
+  TEST_ASSERT_EQUAL(store.count, numberOfRecords);
+  SampleRecord_initCoder(&coder);
+  TEST_ASSERT(SampleRecord_decode(&coder, buffer, length, &record) > 0);
+  TEST_ASSERT_EQUAL(10UL * index, record.timestamp);
+  TEST_ASSERT_EQUAL(200 + index, record.value);
+  SampleRecord_consume(&store, 255);
+  TEST_ASSERT_EQUAL(0, store.count);
+}
+
+int main(void)
+{
+  TEST_RUN(test_roundTrip);
+  TEST_RUN(test_invalid);
+  TEST_RUN(test_store);
+  return TEST_RESULT();
+}
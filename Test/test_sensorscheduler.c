@@ -0,0 +1,307 @@
+/*******************| Inclusions |*************************************/
+#include "test.h"
+#include "sensorscheduler_drivers.h"
+#include "ppd42ns_hal.h"
+#include "dht22_hal_host.h"
+
+/**
+ * @brief Host tests of the SensorScheduler module with a scripted driver, the
+ * DHT22 adapter on the simulated data line and the PPD42NS adapter on the
+ * simulated Timer1
+*/
+
+/*******************| Macros |*****************************************/
+#define TEST_POWEROFFTIME               1000
+#define TEST_WARMUPTIME                 2000
+
+/*******************| Global variables |*******************************/
+/**
+ * Scripted driver: every read-out finishes with fakeStatus on the first poll,
+ * starts and power switching are logged with their time
+ */
+static SensorSchedulerStatus_t fakeStatus;
+static uint16_t fakeNow;
+static uint16_t fakeStarts;
+static uint16_t fakeLastStart;
+static uint16_t fakePowerOffTime;
+static uint16_t fakePowerOnTime;
+static uint8_t fakePowered;
+
+/**
+ * DHT22 timer, frozen while timerFrozen is set, thus a read-out never ends
+ */
+static uint8_t timerFrozen;
+static uint32_t toggles[DHT22_HOSTMAXTOGGLES];
+
+/*******************| Function definition |****************************/
+static SensorSchedulerStatus_t fakeStart(void *context)
+{
+  (void)context;
+  TEST_ASSERT(fakePowered);
+  fakeStarts++;
+  fakeLastStart = fakeNow;
+  return SensorSchedulerStatus_Busy;
+}
+
+static SensorSchedulerStatus_t fakePoll(void *context)
+{
+  (void)context;
+  return fakeStatus;
+}
+
+static uint8_t fakeResult(void *context, sint32_t *values)
+{
+  (void)context;
+  values[0] = 1;
+  return 1;
+}
+
+static void fakeSetPower(uint8_t on)
+{
+  fakePowered = on;
+  if (on)
+  {
+    fakePowerOnTime = fakeNow;
+  }
+  else
+  {
+    fakePowerOffTime = fakeNow;
+  }
+}
+
+static const SensorScheduler_Driver_t fakeDriver = { fakeStart, fakePoll, fakeResult, 0 };
+static const SensorScheduler_Driver_t fakeSlowDriver = { fakeStart, fakePoll, fakeResult, DHT22_MINREADINTERVAL };
+
+static void initFake(SensorScheduler_t *scheduler, SensorScheduler_Entry_t *entry, const SensorScheduler_Driver_t *driver, uint16_t warmUpTime)
+{
+  entry->driver = driver;
+  entry->context = NULL;
+  entry->period = 5000;
+  entry->deadline = 100;
+  entry->retryDelay = 100;
+  entry->setPower = fakeSetPower;
+  entry->powerOffTime = TEST_POWEROFFTIME;
+  entry->warmUpTime = warmUpTime;
+  fakeStatus = SensorSchedulerStatus_Done;
+  fakeNow = 0;
+  fakeStarts = 0;
+  fakePowered = 1;
+  SensorScheduler_init(scheduler, entry, 1, fakeNow);
+}
+
+/**
+ * Call the scheduler every 10ms until the given time
+ */
+static void runUntil(SensorScheduler_t *scheduler, uint16_t time)
+{
+  while (fakeNow != time)
+  {
+    fakeNow += 10;
+    SensorScheduler_run(scheduler, fakeNow);
+  }
+}
+
+static void test_warmUp(void)
+{
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry;
+
+  initFake(&scheduler, &entry, &fakeDriver, TEST_WARMUPTIME);
+  TEST_ASSERT_EQUAL(TEST_WARMUPTIME, SensorScheduler_idleTime(&scheduler, fakeNow));
+  runUntil(&scheduler, TEST_WARMUPTIME - 10);
+  TEST_ASSERT_EQUAL(0, fakeStarts);
+  runUntil(&scheduler, TEST_WARMUPTIME);
+  TEST_ASSERT_EQUAL(1, fakeStarts);
+  /* beyond the 32767ms range of due, e.g. the PPD42NS heater */
+  initFake(&scheduler, &entry, &fakeDriver, SENSORSCHEDULER_PPD42NSWARMUPTIME);
+  runUntil(&scheduler, SENSORSCHEDULER_PPD42NSWARMUPTIME - 10);
+  TEST_ASSERT_EQUAL(0, fakeStarts);
+  runUntil(&scheduler, SENSORSCHEDULER_PPD42NSWARMUPTIME);
+  TEST_ASSERT_EQUAL(1, fakeStarts);
+}
+
+static void test_powerCycle(void)
+{
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry;
+  uint16_t failedStart;
+
+  initFake(&scheduler, &entry, &fakeDriver, TEST_WARMUPTIME);
+  fakeStatus = SensorSchedulerStatus_Error;
+  while (entry.consecutiveFailures < SENSORSCHEDULER_POWERCYCLEFAILURES)
+  {
+    runUntil(&scheduler, (uint16_t)(fakeNow + 10));
+  }
+  TEST_ASSERT_EQUAL(SENSORSCHEDULER_POWERCYCLEFAILURES, fakeStarts);
+  TEST_ASSERT_EQUAL(1, entry.statistics.powerCycles);
+  TEST_ASSERT_EQUAL(SensorSchedulerHealth_Degraded, entry.health);
+  /* off for powerOffTime, then on and read after the warm-up */
+  TEST_ASSERT_EQUAL(0, fakePowered);
+  failedStart = fakeLastStart;
+  fakeStatus = SensorSchedulerStatus_Done;
+  runUntil(&scheduler, (uint16_t)(fakePowerOffTime + TEST_POWEROFFTIME + TEST_WARMUPTIME + 100));
+  TEST_ASSERT_EQUAL(1, fakePowered);
+  TEST_ASSERT_EQUAL(TEST_POWEROFFTIME, (uint16_t)(fakePowerOnTime - fakePowerOffTime));
+  TEST_ASSERT_EQUAL(SENSORSCHEDULER_POWERCYCLEFAILURES + 1, fakeStarts);
+  TEST_ASSERT_EQUAL(TEST_WARMUPTIME, (uint16_t)(fakeLastStart - fakePowerOnTime));
+  TEST_ASSERT(fakeLastStart != failedStart);
+  TEST_ASSERT_EQUAL(SensorSchedulerHealth_Ok, entry.health);
+}
+
+static void test_minRetryDelay(void)
+{
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry;
+  uint16_t failedStart;
+
+  initFake(&scheduler, &entry, &fakeSlowDriver, 0);
+  fakeStatus = SensorSchedulerStatus_Error;
+  runUntil(&scheduler, 10);
+  TEST_ASSERT_EQUAL(1, fakeStarts);
+  failedStart = fakeLastStart;
+  /* retryDelay of 100ms is raised to the DHT22 minimum read interval */
+  runUntil(&scheduler, (uint16_t)(failedStart + DHT22_MINREADINTERVAL));
+  TEST_ASSERT_EQUAL(1, fakeStarts);
+  runUntil(&scheduler, (uint16_t)(failedStart + DHT22_MINREADINTERVAL + 20));
+  TEST_ASSERT_EQUAL(2, fakeStarts);
+  TEST_ASSERT(fakeLastStart - failedStart >= DHT22_MINREADINTERVAL);
+}
+
+static uint16_t readTimer(void)
+{
+  return timerFrozen ? 0 : DHT22_hostReadTimer();
+}
+
+static void test_dht22Abandoned(void)
+{
+  DHT22_Handle_t handle = { 0 };
+  SensorScheduler_Dht22_t context;
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry = { 0 };
+  SensorScheduler_Entry_t *finished = NULL;
+  sint32_t values[SENSORSCHEDULER_MAXVALUES];
+
+  DHT22_hostInit();
+  DHT22_hostSetResponse(0, toggles, DHT22_hostEncodeFrame(584, 227, toggles));
+  DHT22_initSensor(&handle, &DHT22_hostPin[0]);
+  context.handle = &handle;
+  context.readTimer = readTimer;
+  entry.driver = &SensorScheduler_dht22Driver;
+  entry.context = &context;
+  entry.period = 5000;
+  entry.deadline = 100;
+  entry.retryDelay = 100;
+  fakeNow = 0;
+  /* a read-out stuck in progress is abandoned after twice the deadline */
+  timerFrozen = 1;
+  SensorScheduler_init(&scheduler, &entry, 1, fakeNow);
+  while (finished == NULL)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + 1000);
+    finished = SensorScheduler_run(&scheduler, ++fakeNow);
+  }
+  TEST_ASSERT_EQUAL(SensorSchedulerStatus_Error, entry.status);
+  TEST_ASSERT_EQUAL(2 * 100 + 1, fakeNow);
+  TEST_ASSERT_EQUAL(DHT22State_ReadInProgress, handle.state);
+  /* the retry after DHT22_MINREADINTERVAL starts a new read-out */
+  timerFrozen = 0;
+  finished = NULL;
+  while (finished == NULL)
+  {
+    DHT22_hostRunUntil(DHT22_hostTime + 1000);
+    finished = SensorScheduler_run(&scheduler, ++fakeNow);
+  }
+  TEST_ASSERT_EQUAL(SensorSchedulerStatus_Done, entry.status);
+  TEST_ASSERT_EQUAL(2, handle.statistics.readCounter);
+  TEST_ASSERT_EQUAL(1, handle.statistics.timeoutCounter);
+  TEST_ASSERT_EQUAL(2, SensorScheduler_readResult(&entry, values));
+  TEST_ASSERT_EQUAL(227, values[0]);
+  TEST_ASSERT_EQUAL(584, values[1]);
+}
+
+static void test_deadlineClamped(void)
+{
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry;
+
+  initFake(&scheduler, &entry, &fakeDriver, 0);
+  entry.deadline = 40000;
+  SensorScheduler_init(&scheduler, &entry, 1, fakeNow);
+  TEST_ASSERT_EQUAL(0x7fff, entry.deadline);
+}
+
+/**
+ * One timer period with a low pulse on both channels of PPD42NS sensor 0,
+ * then run the scheduler
+ */
+static SensorScheduler_Entry_t *runPpd42nsPeriod(SensorScheduler_t *scheduler, uint8_t pulses)
+{
+  if (pulses)
+  {
+    PPD42NS_hostEdge(0, 0, 1000);
+    PPD42NS_hostEdge(0, 1, 2000);
+    PPD42NS_hostEdge(1, 0, 3000);
+    PPD42NS_hostEdge(1, 1, 4000);
+  }
+  PPD42NS_hostOverflow();
+  fakeNow += 66;
+  return SensorScheduler_run(scheduler, fakeNow);
+}
+
+static void test_ppd42nsEdgeError(void)
+{
+  const PPD42NS_Config_t config = { 1, 16, NULL };
+  SensorScheduler_Ppd42ns_t context = { 0, 0, 0 };
+  SensorScheduler_t scheduler;
+  SensorScheduler_Entry_t entry = { 0 };
+  SensorScheduler_Entry_t *finished;
+  uint16_t errors = 0;
+  uint16_t flagged = 0;
+  uint16_t period;
+
+  PPD42NS_init(&config);
+  entry.driver = &SensorScheduler_ppd42nsDriver;
+  entry.context = &context;
+  entry.period = 66;
+  entry.deadline = 200;
+  entry.retryDelay = 66;
+  entry.setPower = fakeSetPower;
+  entry.powerOffTime = TEST_POWEROFFTIME;
+  fakeNow = 0;
+  fakePowered = 1;
+  SensorScheduler_init(&scheduler, &entry, 1, fakeNow);
+  /* one duplicated falling edge stays in the window for 16 buckets */
+  runPpd42nsPeriod(&scheduler, 1);
+  PPD42NS_hostEdge(0, 0, 1000);
+  PPD42NS_hostEdge(0, 0, 1100);
+  PPD42NS_hostEdge(0, 1, 2000);
+  for (period = 0; period < 40; period++)
+  {
+    finished = runPpd42nsPeriod(&scheduler, 1);
+    if (finished == NULL) continue;
+    if (finished->status == SensorSchedulerStatus_Error) errors++;
+    if (context.errorChannels) flagged++;
+  }
+  TEST_ASSERT_EQUAL(0, errors);
+  TEST_ASSERT_EQUAL(1, flagged);
+  TEST_ASSERT_EQUAL(0, entry.statistics.powerCycles);
+  TEST_ASSERT_EQUAL(SensorSchedulerHealth_Ok, entry.health);
+  /* a silent sensor fails and is power cycled */
+  for (period = 0; period < PPD42NS_SILENTBUCKETS + 4 * entry.period; period++)
+  {
+    runPpd42nsPeriod(&scheduler, 0);
+  }
+  TEST_ASSERT(entry.statistics.errorCounter >= SENSORSCHEDULER_POWERCYCLEFAILURES);
+  TEST_ASSERT(entry.statistics.powerCycles >= 1);
+}
+
+int main(void)
+{
+  TEST_RUN(test_warmUp);
+  TEST_RUN(test_powerCycle);
+  TEST_RUN(test_minRetryDelay);
+  TEST_RUN(test_dht22Abandoned);
+  TEST_RUN(test_deadlineClamped);
+  TEST_RUN(test_ppd42nsEdgeError);
+  return TEST_RESULT();
+}
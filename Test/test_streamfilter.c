@@ -0,0 +1,162 @@
+/*******************| Inclusions |*************************************/
+#include <stdio.h>
+#include "test.h"
+#include "streamfilter.h"
+#include "ppd42ns.h"
+
+/**
+ * @brief Host tests of the StreamFilter module
+*/
+
+/*******************| Macros |*****************************************/
+
+/*******************| Global variables |*******************************/
+static StreamFilter_Channel_t channel;
+static StreamFilter_Statistics_t statistics;
+
+/*******************| Function definition |****************************/
+static void test_deadband(void)
+{
+  const StreamFilter_Config_t config = { 10, 0, 0, 0, 2, 0 };
+
+  StreamFilter_init(&channel, &config);
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_FIRST, StreamFilter_update(&channel, 100, 0));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 109, 1));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 91, 2));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_DEADBAND, StreamFilter_update(&channel, 110, 3));
+  /* relative to the last reported value */
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 119, 4));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_DEADBAND, StreamFilter_update(&channel, 100, 5));
+  /* init restarts with a first report */
+  StreamFilter_init(&channel, &config);
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_FIRST, StreamFilter_update(&channel, 100, 6));
+}
+
+static void test_cusum(void)
+{
+  const StreamFilter_Config_t config = { 0, 1, 10, 0, 2, 0 };
+  uint8_t sample;
+
+  StreamFilter_init(&channel, &config);
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_FIRST, StreamFilter_update(&channel, 100, 0));
+  /* noise within the drift is never reported */
+  for (sample = 0; sample < 100; sample++)
+  {
+    TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, (sample & 1) ? 99 : 101, sample));
+  }
+  /* a persistent offset of 3 sums up by 2 per sample beyond the drift */
+  for (sample = 0; sample < 5; sample++)
+  {
+    TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 103, sample));
+  }
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_CUSUM, StreamFilter_update(&channel, 103, 5));
+  /* the same downwards, relative to the reported 103 */
+  for (sample = 0; sample < 5; sample++)
+  {
+    TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 100, sample));
+  }
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_CUSUM, StreamFilter_update(&channel, 100, 5));
+}
+
+static void test_heartbeat(void)
+{
+  const StreamFilter_Config_t config = { 0, 0, 0, 100, 2, 0 };
+
+  StreamFilter_init(&channel, &config);
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_FIRST, StreamFilter_update(&channel, 100, 65500));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 100, 65535));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 100, 63));
+  /* across the time wrap */
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_HEARTBEAT, StreamFilter_update(&channel, 100, 64));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_NONE, StreamFilter_update(&channel, 100, 163));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_HEARTBEAT, StreamFilter_update(&channel, 100, 164));
+}
+
+static void test_statistics(void)
+{
+  const StreamFilter_Config_t config = { 0, 0, 0, 0, 4, 0 };
+  uint16_t sample;
+
+  StreamFilter_init(&channel, &config);
+  StreamFilter_update(&channel, 50, 0);
+  StreamFilter_update(&channel, -20, 0);
+  StreamFilter_update(&channel, 70, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(3, statistics.count);
+  TEST_ASSERT_EQUAL(-20, statistics.minimum);
+  TEST_ASSERT_EQUAL(70, statistics.maximum);
+  /* minimum and maximum restart with the next value */
+  StreamFilter_resetStatistics(&channel);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(0, statistics.count);
+  StreamFilter_update(&channel, 30, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(1, statistics.count);
+  TEST_ASSERT_EQUAL(30, statistics.minimum);
+  TEST_ASSERT_EQUAL(30, statistics.maximum);
+
+  /* a constant value, the mean converges to it in Q8 and the variance to 0 */
+  for (sample = 0; sample < 400; sample++) StreamFilter_update(&channel, 100, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_WITHIN(16, 100 * 256, statistics.mean);
+  TEST_ASSERT_WITHIN(16, 0, statistics.variance);
+  /* +-10 around 100, a variance of 100 in Q8 */
+  for (sample = 0; sample < 400; sample++) StreamFilter_update(&channel, (sample & 1) ? 90 : 110, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_WITHIN(256, 100 * 256, statistics.mean);
+  TEST_ASSERT_WITHIN(2560, 100 * 256, statistics.variance);
+  TEST_ASSERT_EQUAL(801, statistics.count);
+  TEST_ASSERT_EQUAL(0, statistics.outOfRange);
+}
+
+static void test_largeValues(void)
+{
+  StreamFilter_Config_t config = { 1000, 0, 0, 0, 4, 4 };
+  sint32_t concentration = (sint32_t)PPD42NS_calculateConcentration(0xffff);
+  uint8_t sample;
+
+  /* PPD42NS concentrations exceed the Q8 mean, they are scaled by valueShift */
+  StreamFilter_init(&channel, &config);
+  for (sample = 0; sample < 100; sample++) StreamFilter_update(&channel, concentration, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL((concentration >> 4) * 256, statistics.mean);
+  TEST_ASSERT_EQUAL(0, statistics.variance);
+  TEST_ASSERT_EQUAL(concentration, statistics.maximum);
+  TEST_ASSERT_EQUAL(0, statistics.outOfRange);
+
+  /* without scaling they are clamped and counted */
+  config.valueShift = 0;
+  StreamFilter_init(&channel, &config);
+  StreamFilter_update(&channel, concentration, 0);
+  StreamFilter_update(&channel, -concentration, 0);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(2, statistics.outOfRange);
+  TEST_ASSERT_EQUAL(-concentration, statistics.minimum);
+  TEST_ASSERT_EQUAL(concentration, statistics.maximum);
+  TEST_ASSERT((statistics.mean >= -STREAMFILTER_MAXSCALEDVALUE * 256) && (statistics.mean <= STREAMFILTER_MAXSCALEDVALUE * 256));
+
+  /* the full range is clamped to STREAMFILTER_MAXVALUE, change detection keeps working */
+  config.cusumDrift = 1000;
+  config.cusumThreshold = 1000000;
+  StreamFilter_init(&channel, &config);
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_FIRST, StreamFilter_update(&channel, -0x7fffffffL - 1, 0));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_DEADBAND | STREAMFILTER_REPORT_CUSUM, StreamFilter_update(&channel, 0x7fffffffL, 0));
+  TEST_ASSERT_EQUAL(STREAMFILTER_REPORT_DEADBAND | STREAMFILTER_REPORT_CUSUM, StreamFilter_update(&channel, -0x7fffffffL - 1, 0));
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(3, statistics.outOfRange);
+  TEST_ASSERT_EQUAL(-STREAMFILTER_MAXVALUE, statistics.minimum);
+  TEST_ASSERT_EQUAL(STREAMFILTER_MAXVALUE, statistics.maximum);
+  StreamFilter_resetStatistics(&channel);
+  StreamFilter_readStatistics(&channel, &statistics);
+  TEST_ASSERT_EQUAL(0, statistics.outOfRange);
+}
+
+int main(void)
+{
+  TEST_RUN(test_deadband);
+  TEST_RUN(test_cusum);
+  TEST_RUN(test_heartbeat);
+  TEST_RUN(test_statistics);
+  TEST_RUN(test_largeValues);
+  return TEST_RESULT();
+}
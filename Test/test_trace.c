@@ -0,0 +1,135 @@
+/*******************| Inclusions |*************************************/
+#include <stdio.h>
+#include "test.h"
+#include "trace.h"
+
+/**
+ * @brief Host tests of the Trace module
+*/
+
+/*******************| Macros |*****************************************/
+#define TRACE_TESTMAXEVENTS             16
+
+/*******************| Global variables |*******************************/
+/**
+ * Logic analyzer export with pre-trigger samples, channel 1 starts low
+ */
+static const char csvTrace[] =
+  "Time [s], Channel 0, Channel 1\r\n"
+  "-0.000100000, 1, 0\r\n"
+  "-0.000050000, 1, 0\r\n"
+  "0.000000000, 0, 0\r\n"
+  "0.0000305004, 0, 1\r\n"
+  "0.000080, 1, 1\r\n"
+  "1.5, 0, 1\r\n";
+
+static Trace_Event_t events[TRACE_TESTMAXEVENTS];
+
+/*******************| Function definition |****************************/
+static void expectEvent(const Trace_Event_t *event, uint32_t timestamp, uint8_t channel, uint8_t level)
+{
+  TEST_ASSERT_EQUAL(timestamp, event->timestamp);
+  TEST_ASSERT_EQUAL(channel, event->channel);
+  TEST_ASSERT_EQUAL(level, event->level);
+}
+
+static void test_parseCsv(void)
+{
+  uint16_t numberOfEvents;
+
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_parseCsv(csvTrace, events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(5, numberOfEvents);
+  expectEvent(&events[0], 0, 1, 0);
+  expectEvent(&events[1], 100, 0, 0);
+  /* fraction rounded to us */
+  expectEvent(&events[2], 131, 1, 1);
+  expectEvent(&events[3], 180, 0, 1);
+  expectEvent(&events[4], 1500100, 0, 0);
+  /* trace does not fit */
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseCsv(csvTrace, events, 4, &numberOfEvents));
+  /* malformed lines and times going backwards */
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseCsv("0.1, 1\n0.2, x\n", events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseCsv("0.1\n", events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseCsv("0.2, 1\n0.1, 0\n", events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+}
+
+static void test_binary(void)
+{
+  uint8_t data[TRACE_BINARYMAGICLENGTH + 6 * TRACE_TESTMAXEVENTS];
+  Trace_Event_t decoded[TRACE_TESTMAXEVENTS];
+  uint16_t numberOfEvents;
+  uint16_t decodedEvents;
+  uint32_t length;
+  uint16_t event;
+
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_parseCsv(csvTrace, events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_encodeBinary(events, numberOfEvents, data, sizeof(data), &length));
+  /* records with deltas below 128us take 2 bytes, 1.5s takes 4 */
+  TEST_ASSERT_EQUAL(TRACE_BINARYMAGICLENGTH + 4 * 2 + 4, length);
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_parseBinary(data, length, decoded, TRACE_TESTMAXEVENTS, &decodedEvents));
+  TEST_ASSERT_EQUAL(numberOfEvents, decodedEvents);
+  for (event = 0; event < numberOfEvents; event++)
+  {
+    expectEvent(&decoded[event], events[event].timestamp, events[event].channel, events[event].level);
+  }
+  /* truncated record, missing magic, too small buffer */
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseBinary(data, length - 1, decoded, TRACE_TESTMAXEVENTS, &decodedEvents));
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_parseBinary(data + 1, length - 1, decoded, TRACE_TESTMAXEVENTS, &decodedEvents));
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_encodeBinary(events, numberOfEvents, data, length - 1, &length));
+}
+
+static void test_load(void)
+{
+  uint8_t data[TRACE_BINARYMAGICLENGTH + 6 * TRACE_TESTMAXEVENTS];
+  const char *path = "test_trace.csv";
+  FILE *file;
+  uint16_t numberOfEvents;
+  uint32_t length;
+
+  file = fopen(path, "wb");
+  TEST_ASSERT(file != NULL);
+  if (file == NULL) return;
+  fputs(csvTrace, file);
+  fclose(file);
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_load(path, events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(5, numberOfEvents);
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_encodeBinary(events, numberOfEvents, data, sizeof(data), &length));
+  file = fopen(path, "wb");
+  TEST_ASSERT(file != NULL);
+  if (file == NULL) return;
+  fwrite(data, 1, length, file);
+  fclose(file);
+  TEST_ASSERT_EQUAL(TRACE_OK, Trace_load(path, events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+  TEST_ASSERT_EQUAL(5, numberOfEvents);
+  expectEvent(&events[4], 1500100, 0, 0);
+  remove(path);
+  TEST_ASSERT_EQUAL(TRACE_NOT_OK, Trace_load(path, events, TRACE_TESTMAXEVENTS, &numberOfEvents));
+}
+
+static void test_distortion(void)
+{
+  Trace_Distortion_t distortion = { -1000, 0, 100 };
+  uint32_t randomState = 1;
+  uint32_t timestamp;
+  uint16_t edge;
+
+  TEST_ASSERT_EQUAL(1000000, Trace_distortTimestamp(NULL, 1000000, &randomState));
+  /* latency is left to the backend */
+  TEST_ASSERT_EQUAL(999000, Trace_distortTimestamp(&distortion, 1000000, &randomState));
+  distortion.skewPpm = 0;
+  distortion.jitter = 10;
+  for (edge = 0; edge < 1000; edge++)
+  {
+    timestamp = Trace_distortTimestamp(&distortion, 5000, &randomState);
+    TEST_ASSERT((timestamp >= 5000) && (timestamp <= 5010));
+  }
+}
+
+int main(void)
+{
+  TEST_RUN(test_parseCsv);
+  TEST_RUN(test_binary);
+  TEST_RUN(test_load);
+  TEST_RUN(test_distortion);
+  return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/*******************| Inclusions |*************************************/
+#include "timebase.h"
+
+/**
+ * @brief Extend a free running 16 bit hardware counter to 32 bit
+ * The overflow interrupt calls Timebase_overflow, capture values and counter
+ * readings are extended with the time of the last handled overflow. An
+ * overflow which already happened but was not handled yet (capture and
+ * overflow flag set in the same interrupt, or reading with the overflow
+ * interrupt pending) is taken into account by the value of the counter: small
+ * values were taken after the overflow, large ones before.
+ * Captures are best extended relative to a counter reading taken after them,
+ * see Timebase_extendCapture.
+ * The extended time wraps after 2^32 ticks (71 minutes at 1MHz), thus only
+ * differences must be used. Unsigned subtraction gives the correct result
+ * for any interval shorter than that, no rebasing is needed. One timebase
+ * per hardware counter can be shared by all drivers using this counter, e.g.
+ * PPD42NS and DHT22 edge timing on Timer1.
+*/
+
+/*******************| Macros |*****************************************/
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+void Timebase_init(Timebase_t *timebase)
+{
+  timebase->overflowTime = 0;
+}
+
+/**
+ * Must be called by the overflow interrupt, after pending capture values were
+ * extended.
+ */
+void Timebase_overflow(Timebase_t *timebase)
+{
+  timebase->overflowTime += TIMEBASE_PERIOD;
+}
+
+/**
+ * Extend a counter or capture value. Overflow time must not change meanwhile,
+ * i.e. call from the overflow interrupt or use Timebase_read.
+ * @param timebase timebase of the counter
+ * @param counterValue 16 bit counter or capture value
+ * @param overflowPending not 0 if the overflow flag was set when or after the
+ * value was taken and Timebase_overflow was not called yet
+ * @return extended time
+ */
+uint32_t Timebase_extend(const Timebase_t *timebase, uint16_t counterValue, uint8_t overflowPending)
+{
+  uint32_t time = timebase->overflowTime + counterValue;
+
+  if (overflowPending && (counterValue < TIMEBASE_HALFPERIOD)) time += TIMEBASE_PERIOD;
+  return time;
+}
+
+/**
+ * Extend a capture value relative to an extended counter reading taken after
+ * the capture, e.g. at entry of the capture interrupt. Unlike Timebase_extend
+ * this holds for any capture at most one period older than the reading, also
+ * for a capture just before an overflow which was already handled.
+ * @param time extended time of the counter reading
+ * @param counterValue 16 bit counter value of that reading
+ * @param captureValue 16 bit capture value taken before the reading
+ * @return extended time of the capture
+ */
+uint32_t Timebase_extendCapture(uint32_t time, uint16_t counterValue, uint16_t captureValue)
+{
+  return time - (uint16_t)(counterValue - captureValue);
+}
+
+/**
+ * Read current extended time with interrupts enabled. If the overflow
+ * interrupt runs while reading, the reading is repeated.
+ * @param timebase timebase of the counter
+ * @param counter access to the hardware counter
+ * @return extended time
+ */
+uint32_t Timebase_read(const Timebase_t *timebase, const Timebase_Counter_t *counter)
+{
+  uint32_t overflowTime;
+  uint16_t counterValue;
+  uint8_t overflowPending;
+
+  do
+  {
+    overflowTime = timebase->overflowTime;
+    counterValue = counter->readCounter();
+    overflowPending = counter->overflowPending();
+  } while (overflowTime != timebase->overflowTime);
+  overflowTime += counterValue;
+  if (overflowPending && (counterValue < TIMEBASE_HALFPERIOD)) overflowTime += TIMEBASE_PERIOD;
+  return overflowTime;
+}
@@ -0,0 +1,48 @@
+/** @ingroup Timebase
+ * @{
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+/* Ticks per overflow of the 16 bit hardware counter */
+#define TIMEBASE_PERIOD                         0x10000UL
+
+/* Captured values below half a period with an unhandled overflow were taken
+ * after the overflow. Holds as long as the overflow interrupt is handled
+ * within half a period (32ms at 1MHz). */
+#define TIMEBASE_HALFPERIOD                     0x8000U
+
+/*******************| Type definitions |*******************************/
+/**
+ * Extended time of one 16 bit hardware counter
+ */
+typedef struct
+{
+  volatile uint32_t overflowTime;               /*!< extended time of the last handled overflow */
+} Timebase_t;
+
+/**
+ * Access to the hardware counter for Timebase_read
+ */
+typedef struct
+{
+  uint16_t (*readCounter)(void);               /*!< must not be torn by interrupts reading the counter, e.g. latched high bytes */
+  uint8_t (*overflowPending)(void);             /*!< not 0 if overflow occurred but Timebase_overflow was not called yet */
+} Timebase_Counter_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+void Timebase_init(Timebase_t *timebase);
+void Timebase_overflow(Timebase_t *timebase);
+uint32_t Timebase_extend(const Timebase_t *timebase, uint16_t counterValue, uint8_t overflowPending);
+uint32_t Timebase_extendCapture(uint32_t time, uint16_t counterValue, uint16_t captureValue);
+uint32_t Timebase_read(const Timebase_t *timebase, const Timebase_Counter_t *counter);
+
+#endif
+/** @}*/
@@ -0,0 +1,283 @@
+/*******************| Inclusions |*************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+/**
+ * @brief Loader of edge traces and timestamp distortion for replays
+*/
+
+/*******************| Macros |*****************************************/
+/* fractional digits of a CSV time kept, i.e. us */
+#define TRACE_CSVFRACTIONDIGITS                 6
+
+/*******************| Type definitions |*******************************/
+
+/*******************| Function prototypes |****************************/
+static const char *Trace_skipBlanks(const char *text);
+static const char *Trace_parseTime(const char *text, int64_t *time);
+static uint8_t Trace_addEvent(Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents, uint32_t timestamp, uint8_t channel, uint8_t level);
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function definition |****************************/
+/**
+ * Convert a logic analyzer CSV export into edges. A line not starting with a
+ * time is skipped as header. The first sample point gives the levels at the
+ * start of the trace: lines idle high, thus a channel low there gives a
+ * falling edge at time 0. Afterwards each level change of a channel is an
+ * edge, sample points without change are allowed.
+ * @param text CSV file contents, NUL terminated
+ * @param events receives the edges sorted by time
+ * @param maxEvents size of events
+ * @param numberOfEvents receives the number of edges stored
+ * @return TRACE_OK, TRACE_NOT_OK if a line is malformed, times go backwards
+ * or the trace does not fit into events
+ */
+uint8_t Trace_parseCsv(const char *text, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents)
+{
+  uint8_t levels[TRACE_MAXCHANNELS];
+  int64_t start = 0;
+  int64_t previous = 0;
+  int64_t time;
+  uint8_t firstLine = 1;
+  uint8_t channel;
+  uint8_t level;
+
+  *numberOfEvents = 0;
+  while (*text)
+  {
+    text = Trace_skipBlanks(text);
+    if ((*text == '-') || (*text == '.') || ((*text >= '0') && (*text <= '9')))
+    {
+      text = Trace_parseTime(text, &time);
+      if (text == NULL) return TRACE_NOT_OK;
+      if (firstLine) start = previous = time;
+      if (time < previous) return TRACE_NOT_OK;
+      previous = time;
+      for (channel = 0; ; channel++)
+      {
+        text = Trace_skipBlanks(text);
+        if (*text != ',') break;
+        text = Trace_skipBlanks(text + 1);
+        if ((*text != '0') && (*text != '1')) return TRACE_NOT_OK;
+        level = (uint8_t)(*text++ - '0');
+        if (channel >= TRACE_MAXCHANNELS) continue;
+        if (firstLine ? (level == 0) : (level != levels[channel]))
+        {
+          if (Trace_addEvent(events, maxEvents, numberOfEvents, (uint32_t)(time - start), channel, level) != TRACE_OK) return TRACE_NOT_OK;
+        }
+        levels[channel] = level;
+      }
+      if (channel == 0) return TRACE_NOT_OK;
+      if ((*text != '\r') && (*text != '\n') && (*text != '\0')) return TRACE_NOT_OK;
+      firstLine = 0;
+    }
+    /* next line */
+    while ((*text != '\0') && (*text != '\n')) text++;
+    if (*text == '\n') text++;
+  }
+  return TRACE_OK;
+}
+
+/**
+ * Convert a binary trace into edges, see trace.h for the format.
+ * @param data file contents starting with TRACE_BINARYMAGIC
+ * @param length number of bytes
+ * @param events receives the edges
+ * @param maxEvents size of events
+ * @param numberOfEvents receives the number of edges stored
+ * @return TRACE_OK, TRACE_NOT_OK if the magic is missing, the last record is
+ * truncated or the trace does not fit into events
+ */
+uint8_t Trace_parseBinary(const uint8_t *data, uint32_t length, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents)
+{
+  const uint8_t *end = data + length;
+  uint32_t timestamp = 0;
+  uint32_t delta;
+  uint8_t shift;
+
+  *numberOfEvents = 0;
+  if ((length < TRACE_BINARYMAGICLENGTH) || memcmp(data, TRACE_BINARYMAGIC, TRACE_BINARYMAGICLENGTH)) return TRACE_NOT_OK;
+  data += TRACE_BINARYMAGICLENGTH;
+  while (data < end)
+  {
+    delta = 0;
+    for (shift = 0; ; shift += 7)
+    {
+      if ((data >= end) || (shift > 28)) return TRACE_NOT_OK;
+      delta |= (uint32_t)(*data & 0x7f) << shift;
+      if (!(*data++ & 0x80)) break;
+    }
+    if (data >= end) return TRACE_NOT_OK;
+    timestamp += delta;
+    if (Trace_addEvent(events, maxEvents, numberOfEvents, timestamp, (uint8_t)(*data >> 1), (uint8_t)(*data & 0x01)) != TRACE_OK) return TRACE_NOT_OK;
+    data++;
+  }
+  return TRACE_OK;
+}
+
+/**
+ * Store edges in the binary format, e.g. to convert a CSV export once.
+ * @param events edges sorted by time, channels 0..127
+ * @param numberOfEvents number of edges
+ * @param data receives the binary trace
+ * @param maxLength size of data, at most 6 bytes per edge are needed
+ * @param length receives the number of bytes stored
+ * @return TRACE_OK, TRACE_NOT_OK if the edges are not sorted or data is too
+ * small
+ */
+uint8_t Trace_encodeBinary(const Trace_Event_t *events, uint16_t numberOfEvents, uint8_t *data, uint32_t maxLength, uint32_t *length)
+{
+  uint32_t timestamp = 0;
+  uint32_t delta;
+  uint32_t used = TRACE_BINARYMAGICLENGTH;
+
+  *length = 0;
+  if (maxLength < TRACE_BINARYMAGICLENGTH) return TRACE_NOT_OK;
+  memcpy(data, TRACE_BINARYMAGIC, TRACE_BINARYMAGICLENGTH);
+  for (; numberOfEvents; numberOfEvents--, events++)
+  {
+    if ((events->timestamp < timestamp) || (events->channel > 0x7f)) return TRACE_NOT_OK;
+    delta = events->timestamp - timestamp;
+    timestamp = events->timestamp;
+    do
+    {
+      if (used >= maxLength) return TRACE_NOT_OK;
+      data[used++] = (uint8_t)((delta & 0x7f) | ((delta > 0x7f) ? 0x80 : 0));
+      delta >>= 7;
+    } while (delta);
+    if (used >= maxLength) return TRACE_NOT_OK;
+    data[used++] = (uint8_t)((events->channel << 1) | (events->level ? 1 : 0));
+  }
+  *length = used;
+  return TRACE_OK;
+}
+
+/**
+ * Read a trace file, binary if it starts with TRACE_BINARYMAGIC, CSV
+ * otherwise.
+ * @param path file name
+ * @param events receives the edges
+ * @param maxEvents size of events
+ * @param numberOfEvents receives the number of edges stored
+ * @return TRACE_OK, TRACE_NOT_OK if the file can not be read or parsed
+ */
+uint8_t Trace_load(const char *path, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents)
+{
+  FILE *file = fopen(path, "rb");
+  char *contents;
+  long length;
+  uint8_t result = TRACE_NOT_OK;
+
+  *numberOfEvents = 0;
+  if (file == NULL) return TRACE_NOT_OK;
+  if ((fseek(file, 0, SEEK_END) == 0) && ((length = ftell(file)) >= 0) && (fseek(file, 0, SEEK_SET) == 0))
+  {
+    contents = (char *)malloc((size_t)length + 1);
+    if ((contents != NULL) && (fread(contents, 1, (size_t)length, file) == (size_t)length))
+    {
+      contents[length] = '\0';
+      if ((length >= TRACE_BINARYMAGICLENGTH) && !memcmp(contents, TRACE_BINARYMAGIC, TRACE_BINARYMAGICLENGTH))
+      {
+        result = Trace_parseBinary((const uint8_t *)contents, (uint32_t)length, events, maxEvents, numberOfEvents);
+      }
+      else
+      {
+        result = Trace_parseCsv(contents, events, maxEvents, numberOfEvents);
+      }
+    }
+    free(contents);
+  }
+  fclose(file);
+  return result;
+}
+
+/**
+ * Timestamp of an edge as seen by a timer running off by skewPpm, delayed by
+ * a random jitter. Latency is not added, it depends on the backend whether it
+ * delays the timestamp or only the interrupt.
+ * @param distortion skew and jitter, may be NULL for an exact replay
+ * @param timestamp time of the edge since start of trace in us
+ * @param randomState state of the jitter generator, a fixed seed keeps
+ * replays reproducible
+ * @return distorted timestamp
+ */
+uint32_t Trace_distortTimestamp(const Trace_Distortion_t *distortion, uint32_t timestamp, uint32_t *randomState)
+{
+  if (distortion == NULL) return timestamp;
+  timestamp += (uint32_t)(((int64_t)timestamp * distortion->skewPpm) / 1000000);
+  if (distortion->jitter)
+  {
+    /* linear congruential generator (Numerical Recipes constants) */
+    *randomState = *randomState * 1664525UL + 1013904223UL;
+    timestamp += (uint32_t)(*randomState >> 16) % ((uint32_t)distortion->jitter + 1);
+  }
+  return timestamp;
+}
+
+static const char *Trace_skipBlanks(const char *text)
+{
+  while ((*text == ' ') || (*text == '\t')) text++;
+  return text;
+}
+
+/**
+ * Parse a time in s with decimal fraction into us without float, the
+ * fraction is rounded to TRACE_CSVFRACTIONDIGITS digits.
+ * @return text behind the time, NULL if there is none
+ */
+static const char *Trace_parseTime(const char *text, int64_t *time)
+{
+  int64_t seconds = 0;
+  int64_t fraction = 0;
+  uint8_t digits = 0;
+  uint8_t negative = 0;
+  uint8_t roundUp = 0;
+
+  if (*text == '-')
+  {
+    negative = 1;
+    text++;
+  }
+  if (((*text < '0') || (*text > '9')) && ((text[0] != '.') || (text[1] < '0') || (text[1] > '9'))) return NULL;
+  while ((*text >= '0') && (*text <= '9'))
+  {
+    seconds = seconds * 10 + (*text++ - '0');
+  }
+  if (*text == '.')
+  {
+    text++;
+    while ((*text >= '0') && (*text <= '9'))
+    {
+      if (digits < TRACE_CSVFRACTIONDIGITS)
+      {
+        fraction = fraction * 10 + (*text - '0');
+      }
+      else if (digits == TRACE_CSVFRACTIONDIGITS)
+      {
+        roundUp = (*text >= '5');
+      }
+      digits++;
+      text++;
+    }
+  }
+  for (; digits < TRACE_CSVFRACTIONDIGITS; digits++)
+  {
+    fraction *= 10;
+  }
+  *time = seconds * 1000000 + fraction + roundUp;
+  if (negative) *time = -*time;
+  return text;
+}
+
+static uint8_t Trace_addEvent(Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents, uint32_t timestamp, uint8_t channel, uint8_t level)
+{
+  if (*numberOfEvents >= maxEvents) return TRACE_NOT_OK;
+  events[*numberOfEvents].timestamp = timestamp;
+  events[*numberOfEvents].channel = channel;
+  events[*numberOfEvents].level = level;
+  (*numberOfEvents)++;
+  return TRACE_OK;
+}
@@ -0,0 +1,71 @@
+/** @ingroup Trace
+ * @{
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ * Edge traces for replaying recorded waveforms through the host backends of
+ * the drivers (PPD42NS_hostReplay, DHT22_hostReplay). Host only, not part of
+ * the target build. Traces are read from
+ * - a logic analyzer CSV export: a header line followed by one line per
+ *   sample point "<time in s>, <level of channel 0>, <level of channel 1>, ..."
+ *   (e.g. Saleae Logic "Time [s], Channel 0, Channel 1"). Times may be
+ *   negative (pre-trigger) and are taken relative to the first line.
+ * - a compact binary format: TRACE_BINARYMAGIC followed by one record per
+ *   edge, the time since the previous edge in us as unsigned LEB128 varint and
+ *   one byte channel << 1 | level. An edge usually takes 2..3 bytes.
+ * Replays distort the timestamps with clock skew and jitter, see
+ * Trace_distortTimestamp, interrupt latency is applied by the backend.
+ */
+
+/*******************| Inclusions |*************************************/
+#include <PlatformTypes.h>
+
+/*******************| Macros |*****************************************/
+#if (!defined TRACE_OK)
+#define TRACE_OK        0
+#endif
+
+#if (!defined TRACE_NOT_OK)
+#define TRACE_NOT_OK    1
+#endif
+
+/* first bytes of a binary trace */
+#define TRACE_BINARYMAGIC                       "TRC1"
+#define TRACE_BINARYMAGICLENGTH                 4
+
+/* channels of a CSV line, levels of channels 0..TRACE_MAXCHANNELS-1 */
+#define TRACE_MAXCHANNELS                       8
+
+/*******************| Type definitions |*******************************/
+/**
+ * One edge of a recorded trace
+ */
+typedef struct {
+  uint32_t timestamp;                           /**< time since start of trace in us */
+  uint8_t channel;                              /**< logic analyzer channel */
+  uint8_t level;                                /**< level after the edge, 0 for LOW */
+} Trace_Event_t;
+
+/**
+ * Distortion applied while replaying a trace
+ */
+typedef struct {
+  sint16_t skewPpm;                             /**< timer clock deviation in ppm, positive runs fast */
+  uint16_t jitter;                              /**< maximum random delay added to each edge in us */
+  uint16_t latency;                             /**< delay between edge and interrupt in us */
+} Trace_Distortion_t;
+
+/*******************| Global variables |*******************************/
+
+/*******************| Function prototypes |****************************/
+uint8_t Trace_parseCsv(const char *text, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents);
+uint8_t Trace_parseBinary(const uint8_t *data, uint32_t length, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents);
+uint8_t Trace_encodeBinary(const Trace_Event_t *events, uint16_t numberOfEvents, uint8_t *data, uint32_t maxLength, uint32_t *length);
+uint8_t Trace_load(const char *path, Trace_Event_t *events, uint16_t maxEvents, uint16_t *numberOfEvents);
+uint32_t Trace_distortTimestamp(const Trace_Distortion_t *distortion, uint32_t timestamp, uint32_t *randomState);
+
+#endif
+/** @}*/